@@ -0,0 +1,128 @@
+//Author: Connor Kamrowski. See header file for more information.
+#include "AutosaveWorker.h"
+
+/**
+ * The AutosaveWorker constructor. The thread is started last, once everything it uses is ready.
+ */
+AutosaveWorker::AutosaveWorker() {
+	worker = std::thread(&AutosaveWorker::run, this);
+}
+
+/**
+ * The AutosaveWorker deconstructor. Tell the worker to stop, and wait for it to save everything still pending.
+ */
+AutosaveWorker::~AutosaveWorker() {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	changed.notify_all();
+
+	worker.join();
+}
+
+//Queue a snapshot, replacing any older one for the same file.
+void AutosaveWorker::save(const std::string& path, std::shared_ptr<const TextSnapshot> text) {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		pending[path] = text;
+	}
+	changed.notify_all();
+}
+
+//Check for the file in 'pending' and the file being written.
+bool AutosaveWorker::isSaving(const std::string& path) {
+	std::lock_guard<std::mutex> guard(lock);
+	return pending.count(path) != 0 || writing_path == path;
+}
+
+//Check for a snapshot of the file that failed to be written.
+bool AutosaveWorker::hasFailed(const std::string& path) {
+	std::lock_guard<std::mutex> guard(lock);
+	return failed.count(path) != 0;
+}
+
+//A waiting save is newer than the one being written, which is newer than one that failed.
+std::shared_ptr<const TextSnapshot> AutosaveWorker::getUnsaved(const std::string& path) {
+	std::lock_guard<std::mutex> guard(lock);
+
+	auto waiting = pending.find(path);
+	if (waiting != pending.end()) {
+		return waiting->second;
+	}
+	if (writing_path == path) {
+		return writing_text;
+	}
+
+	auto found = failed.find(path);
+	return (found != failed.end()) ? found->second : nullptr;
+}
+
+//Sleep until the file is neither waiting to be saved, nor being saved.
+void AutosaveWorker::wait(const std::string& path) {
+	std::unique_lock<std::mutex> guard(lock);
+	changed.wait(guard, [&] { return pending.count(path) == 0 && writing_path != path; });
+}
+
+/**
+ * Drop the waiting save, then wait for any save already being written. A snapshot that failed is dropped last, in case
+ * the save being written fails too.
+ */
+void AutosaveWorker::cancel(const std::string& path) {
+	std::unique_lock<std::mutex> guard(lock);
+	pending.erase(path);
+	changed.wait(guard, [&] { return writing_path != path; });
+	failed.erase(path);
+}
+
+//Wait for the worker to finish with the old storage, so it's never used after it's deleted.
+void AutosaveWorker::setStorage(NoteStorage* storage) {
+	std::unique_lock<std::mutex> guard(lock);
+	changed.wait(guard, [&] { return pending.empty() && writing_path.empty(); });
+	this->storage = storage;
+}
+
+/**
+ * Save snapshots until stopped. The lock is only held while taking a snapshot off of 'pending', never while writing,
+ * so the UI thread can keep adding saves while the disk is busy.
+ */
+void AutosaveWorker::run() {
+	std::unique_lock<std::mutex> guard(lock);
+
+	while (true) {
+		changed.wait(guard, [&] { return !pending.empty() || stopping; });
+
+		//Only stop once everything has been saved
+		if (pending.empty()) {
+			return;
+		}
+
+		//take the next save
+		auto next = pending.begin();
+		std::string path = next->first;
+		std::shared_ptr<const TextSnapshot> text = next->second;
+		pending.erase(next);
+		writing_path = path;
+		writing_text = text;
+		NoteStorage* target = storage;
+
+		//write the note without holding the lock
+		guard.unlock();
+		bool saved = target != nullptr && target->write(path, *text);
+		guard.lock();
+
+		//Keep a snapshot that wasn't written, until a later save of the file is written
+		if (saved) {
+			failed.erase(path);
+		}
+		else {
+			std::cout << "ERROR: The Node contents could not be saved. Path: " << path << std::endl;
+			failed[path] = text;
+		}
+
+		writing_path.clear();
+		writing_text = nullptr;
+		changed.notify_all();
+	}
+
+}//END OF run()
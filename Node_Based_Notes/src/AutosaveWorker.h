@@ -0,0 +1,114 @@
+/*
+ * AutosaveWorker saves notes on a background thread, so the event loop never waits on the disk. The text editor hands
+ * it a snapshot of the document, which stays the same while the user keeps typing, and the worker writes it into the
+ * graph's NoteStorage.
+ *
+ * Saves are coalesced: only the newest snapshot waiting for each file is kept, so a burst of saves for the same note
+ * turns into a single write.
+ *
+ * A snapshot that couldn't be written is kept until a later save of the file succeeds. The text editor checks for it,
+ * so the note is saved again instead of being treated as saved, and it's opened from the snapshot if the note is
+ * opened again first.
+ *
+ * Author: Connor Kamrowski
+ */
+#pragma once
+#include "Config.h"
+#include "NoteStorage.h"
+
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+
+class AutosaveWorker {
+public:
+	/**
+	 * AutosaveWorker constructor. Starts the worker thread, which sleeps until there's something to save.
+	 */
+	AutosaveWorker();
+
+	/**
+	 * AutosaveWorker deconstructor. Finishes every save still waiting, then stops the worker thread.
+	 */
+	~AutosaveWorker();
+
+	/**
+	 * Save text to a file in the background. If an older save of the same file hasn't started yet, it's replaced.
+	 *
+	 * \param path: The path of the file to save
+	 * \param text: A snapshot of the text to save
+	 */
+	void save(const std::string& path, std::shared_ptr<const TextSnapshot> text);
+
+	/**
+	 * \return true if a save of the file is waiting or being written.
+	 */
+	bool isSaving(const std::string& path);
+
+	/**
+	 * \return true if the last save of the file couldn't be written.
+	 */
+	bool hasFailed(const std::string& path);
+
+	/**
+	 * Find the newest text of a file that isn't on the disk yet. Used to open a note without waiting for its save.
+	 *
+	 * \param path: The path of the file
+	 * \return The snapshot waiting or being written, or the one that failed to be written. Null if the file is saved
+	 */
+	std::shared_ptr<const TextSnapshot> getUnsaved(const std::string& path);
+
+	/**
+	 * Wait until every save of a file has finished. Used before reading or renaming the file.
+	 *
+	 * \param path: The path of the file
+	 */
+	void wait(const std::string& path);
+
+	/**
+	 * Throw away a save of a file that hasn't started, or that failed, and wait for one that has started. Used before
+	 * deleting the file.
+	 *
+	 * \param path: The path of the file
+	 */
+	void cancel(const std::string& path);
+
+	/**
+	 * Change the storage notes are saved into, once every save waiting has been written to the old one.
+	 *
+	 * \param storage: The storage to save into. Null when no graph is open
+	 */
+	void setStorage(NoteStorage* storage);
+
+private:
+	/**
+	 * The worker thread. Takes saves off of 'pending' and writes them, one at a time, until the worker is stopped.
+	 */
+	void run();
+
+	//The newest snapshot waiting to be saved for each file path
+	std::unordered_map<std::string, std::shared_ptr<const TextSnapshot>> pending;
+
+	//The path of the file being written right now, and the snapshot being written. Empty if the worker is waiting
+	std::string writing_path;
+	std::shared_ptr<const TextSnapshot> writing_text;
+
+	//The snapshot of each file that couldn't be written, until a later save of the file is written
+	std::unordered_map<std::string, std::shared_ptr<const TextSnapshot>> failed;
+
+	//Indicates that the worker should stop once 'pending' is empty
+	bool stopping = false;
+
+	//The storage notes are saved into
+	NoteStorage* storage = nullptr;
+
+	//Guards pending, writing_path, writing_text, failed, stopping and storage
+	std::mutex lock;
+
+	//Wakes the worker when a save is added, and wakes waiting callers when a save finishes
+	std::condition_variable changed;
+
+	//The thread that does the saving
+	std::thread worker;
+
+};
@@ -122,7 +122,7 @@ void ButtonMenu::render(SDL_Renderer* renderer) {
 	Custom_SDLDrawRect(renderer, &WHITE, message_shape);
 
 	//render the message
-	TextureManager::loadWrappedText(renderer, GraphManager::font, message.c_str(), &BLACK, menu_shape->x + MENU_CONTENT_PADDING, menu_shape->y + MENU_CONTENT_PADDING, content_width, MENU_MESSAGE_FONT_SIZE, true);
+	TextureManager::loadCachedWrappedText(renderer, GraphManager::fonts, message, &BLACK, menu_shape->x + MENU_CONTENT_PADDING, menu_shape->y + MENU_CONTENT_PADDING, content_width, MENU_MESSAGE_FONT_SIZE, true);
 
 	//render each of the buttons
 	for (int i = 0; i < buttons.size(); i++) {
@@ -130,7 +130,7 @@ void ButtonMenu::render(SDL_Renderer* renderer) {
 		Custom_SDLDrawRect(renderer, &WHITE, button_shape);
 
 		//then the text over top
-		TextureManager::loadWrappedText(renderer, GraphManager::font, buttons.at(i).c_str(), &BLACK, button_shape->x, button_shape->y, content_width, MENU_BUTTON_FONT_SIZE, true);
+		TextureManager::loadCachedWrappedText(renderer, GraphManager::fonts, buttons.at(i), &BLACK, button_shape->x, button_shape->y, content_width, MENU_BUTTON_FONT_SIZE, true);
 
 		//and increment the button height
 		button_shape->y += MENU_BUTTON_SPACING + MENU_BUTTON_HEIGHT;
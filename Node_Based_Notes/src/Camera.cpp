@@ -0,0 +1,58 @@
+//Author: Connor Kamrowski. See header file for more information.
+#include "Camera.h"
+
+/**
+ * Move the rectangle relative to the camera, then scale it. The far edges are converted rather than the size, so
+ * neighbouring rectangles never leave a gap between them when zoomed.
+ */
+SDL_Rect Camera::worldToScreen(const SDL_Rect& world) const {
+	int left = (int)std::floor((world.x - x) * zoom);
+	int top = (int)std::floor((world.y - y) * zoom);
+	int right = (int)std::floor((world.x + world.w - x) * zoom);
+	int bottom = (int)std::floor((world.y + world.h - y) * zoom);
+
+	//Never shrink anything away completely
+	return { left, top, std::max(1, right - left), std::max(1, bottom - top) };
+}
+
+//Move the point relative to the camera, then scale it.
+void Camera::worldToScreen(double world_x, double world_y, float* screen_x, float* screen_y) const {
+	*screen_x = (float)((world_x - x) * zoom);
+	*screen_y = (float)((world_y - y) * zoom);
+}
+
+//Undo the scale, then the camera's position.
+void Camera::screenToWorld(int screen_x, int screen_y, int* world_x, int* world_y) const {
+	*world_x = (int)std::floor(screen_x / zoom + x);
+	*world_y = (int)std::floor(screen_y / zoom + y);
+}
+
+//The screen's corners, converted to the world.
+SDL_Rect Camera::getViewRect(int screen_w, int screen_h) const {
+	int left, top, right, bottom;
+	screenToWorld(0, 0, &left, &top);
+	screenToWorld(screen_w, screen_h, &right, &bottom);
+
+	//add one so the partly visible edges are included
+	return { left, top, right - left + 1, bottom - top + 1 };
+}
+
+//Moving the mouse right drags the world right, so the camera moves left.
+void Camera::pan(int screen_dx, int screen_dy) {
+	x -= screen_dx / zoom;
+	y -= screen_dy / zoom;
+}
+
+/**
+ * Change the zoom, then move the camera so the world point that was under the mouse is under it again.
+ */
+void Camera::zoomAt(int screen_x, int screen_y, float factor) {
+	//The point in the world under the mouse, before zooming
+	double world_x = screen_x / zoom + x;
+	double world_y = screen_y / zoom + y;
+
+	zoom = std::max(CAMERA_MIN_ZOOM, std::min(zoom * factor, CAMERA_MAX_ZOOM));
+
+	x = world_x - screen_x / zoom;
+	y = world_y - screen_y / zoom;
+}
@@ -0,0 +1,111 @@
+/*
+ * Camera converts between the graph's world coordinates, where nodes live, and the screen coordinates they're drawn
+ * at. It can be panned and zoomed, so a graph can be much larger than the window.
+ *
+ * The camera is described by the world position at the top-left corner of the window, and a zoom. A zoom of 2 draws
+ * everything twice as large.
+ *
+ * Author: Connor Kamrowski
+ */
+#pragma once
+#include "Config.h"
+
+#include <cmath>
+
+//Where a camera is looking, saved so a graph opens where it was left
+struct CameraState {
+	//The world position at the top-left corner of the screen
+	double x = 0;
+	double y = 0;
+
+	//The size things in the world are drawn at, relative to their real size
+	float zoom = 1;
+};
+
+class Camera {
+public:
+	/**
+	 * Convert a rectangle in the world to the rectangle it covers on the screen.
+	 *
+	 * \param world: The rectangle in world coordinates
+	 * \return The rectangle in screen coordinates
+	 */
+	SDL_Rect worldToScreen(const SDL_Rect& world) const;
+
+	/**
+	 * Convert a point in the world to the point it's drawn at on the screen, without rounding.
+	 *
+	 * \param world_x: The x position in the world
+	 * \param world_y: The y position in the world
+	 * \param screen_x: Set to the x position on the screen
+	 * \param screen_y: Set to the y position on the screen
+	 */
+	void worldToScreen(double world_x, double world_y, float* screen_x, float* screen_y) const;
+
+	/**
+	 * Convert a point on the screen to the point in the world under it.
+	 *
+	 * \param screen_x: The x position on the screen
+	 * \param screen_y: The y position on the screen
+	 * \param world_x: Set to the x position in the world
+	 * \param world_y: Set to the y position in the world
+	 */
+	void screenToWorld(int screen_x, int screen_y, int* world_x, int* world_y) const;
+
+	/**
+	 * Find the part of the world that can be seen on a screen.
+	 *
+	 * \param screen_w: The width of the screen
+	 * \param screen_h: The height of the screen
+	 * \return The visible rectangle, in world coordinates
+	 */
+	SDL_Rect getViewRect(int screen_w, int screen_h) const;
+
+	/**
+	 * Move the camera so the world follows the mouse.
+	 *
+	 * \param screen_dx: The distance moved on the screen, horizontally
+	 * \param screen_dy: The distance moved on the screen, vertically
+	 */
+	void pan(int screen_dx, int screen_dy);
+
+	/**
+	 * Zoom in or out, keeping the point in the world under screen_x, screen_y in the same place on the screen.
+	 *
+	 * \param screen_x: The x position to zoom towards, usually the mouse
+	 * \param screen_y: The y position to zoom towards, usually the mouse
+	 * \param factor: The amount to multiply the zoom by. The result is kept between CAMERA_MIN_ZOOM and CAMERA_MAX_ZOOM
+	 */
+	void zoomAt(int screen_x, int screen_y, float factor);
+
+	/**
+	 * \return The current zoom. 1 is the real size.
+	 */
+	float getZoom() const { return zoom; }
+
+	/**
+	 * Move the camera back to the world's origin, at the real size.
+	 */
+	void reset() { x = 0; y = 0; zoom = 1; }
+
+	/**
+	 * \return The position and zoom of the camera.
+	 */
+	CameraState getState() const { return { x, y, zoom }; }
+
+	/**
+	 * Move the camera to a saved position and zoom. The zoom is kept between CAMERA_MIN_ZOOM and CAMERA_MAX_ZOOM.
+	 *
+	 * \param state: The position and zoom to use
+	 */
+	void setState(const CameraState& state) { x = state.x; y = state.y; zoom = std::max(CAMERA_MIN_ZOOM, std::min(state.zoom, CAMERA_MAX_ZOOM)); }
+
+private:
+	//The world position at the top-left corner of the screen
+	double x = 0;
+	double y = 0;
+
+	//The size things in the world are drawn at, relative to their real size
+	float zoom = 1;
+
+};
@@ -20,6 +20,9 @@
 #include <iostream>
 #include <chrono>
 #include <thread>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
 
 //A made up version I attributed to this code.
 const std::string VERSION = "0.2";
@@ -37,6 +40,23 @@ const SDL_Color WHITE = { 255, 255, 255, 255 };
 //A basic full black color using SDL_Color. Often used for rendering text black
 const SDL_Color BLACK = { 0, 0, 0, 255 };
 
+/*** TextureManager / GlyphAtlas ***/
+//The width of a glyph atlas texture. The height grows to fit every glyph of the font size
+const int GLYPH_ATLAS_WIDTH = 512;
+
+//The space left between glyphs in an atlas, so neighboring glyphs don't bleed into each other when scaled
+const int GLYPH_ATLAS_PADDING = 1;
+
+//The first and last characters rasterized into a glyph atlas. This matches the Latin-1 range TTF_RenderText draws
+const int GLYPH_ATLAS_FIRST_CHAR = 32;
+const int GLYPH_ATLAS_LAST_CHAR = 255;
+
+//The number of spaces a tab character is drawn as
+const int TAB_WIDTH = 4;
+
+//The maximum number of bytes of texture memory kept by the cache of static text (menus, buttons, titles)
+const size_t TEXTURE_CACHE_BUDGET = 8 * 1024 * 1024;
+
 /*** GraphManager ***/
 //The nominator and denominator for the window width's scaling. Screen width is multiplied by nominator, 
 // divided by denominator, and the result is the width of the application window. If nom=2 and denom=3,
@@ -51,6 +71,30 @@ const int WINDOW_HEIGHT_DENOM = 3;
 //The background color of the graph manager
 const SDL_Color GRAPH_BACKGROUND_COLOR = { 200, 200, 200, 255 };
 
+//The refresh rate assumed when the display doesn't report one, used to limit frames when vsync isn't available
+const int DEFAULT_REFRESH_RATE = 60;
+
+/*** GraphLoader ***/
+//The most worker threads used to load a graph. Fewer are used if the computer has fewer cores
+const int LOADER_MAX_THREADS = 8;
+
+//The number of notes handed from the directory listing to the other workers at a time
+const int LOAD_BATCH_SIZE = 1024;
+
+//The size, in bytes, of each chunk of the nbg file parsed by a worker
+const int LOAD_CHUNK_SIZE = 64 * 1024;
+
+//How often, in milliseconds, the nodes read so far are added to the graph while it loads
+const int LOAD_POLL_INTERVAL_MS = 16;
+
+//The height of the progress bar shown at the bottom of the window while a graph loads, and the size of its text
+const int LOAD_BAR_HEIGHT = 28;
+const int LOAD_FONT_SIZE = 20;
+
+//The colors of the progress bar, and of the track behind it
+const SDL_Color LOAD_BAR_COLOR = { 100, 10, 100, 255 };
+const SDL_Color LOAD_BAR_TRACK_COLOR = { 40, 10, 40, 255 };
+
 /*** TextEditor ***/
 //The screen width is divided by this integer to determine the width of the text editor
 const int TEXT_EDITOR_WIDTH_FACTOR = 3;
@@ -70,6 +114,51 @@ const int LEFT_TEXT_BUFFER = 5;
 //The background color of the header in the text editor
 const SDL_Color HEADER_BACKGROUND_COLOR = { 200, 150, 200, 255 };
 
+//The number of lines above and below the visible area of the text editor that are drawn, so scrolling never shows a gap
+const int EDITOR_OVERSCAN_LINES = 2;
+
+//The number of pixels the text editor scrolls for each notch of the mouse wheel
+const int EDITOR_SCROLL_SPEED = 60;
+
+//The width of the cursor drawn in the text editor and text menus
+const int CURSOR_WIDTH = 2;
+
+//The color behind selected text
+const SDL_Color SELECTION_COLOR = { 170, 200, 255, 255 };
+
+//The width of the text editor's scroll bar
+const int SCROLL_BAR_WIDTH = 12;
+
+//The smallest height of the scroll bar's thumb, so it can still be grabbed in very long notes
+const int SCROLL_BAR_MIN_THUMB_HEIGHT = 20;
+
+//The colors of the scroll bar's track, and the thumb that is dragged along it
+const SDL_Color SCROLL_BAR_TRACK_COLOR = { 230, 230, 230, 255 };
+const SDL_Color SCROLL_BAR_THUMB_COLOR = { 150, 150, 150, 255 };
+
+/*** GapBuffer ***/
+//The smallest gap left in a GapBuffer when it's filled or grown
+const int GAP_BUFFER_MIN_GAP = 64;
+
+/*** Rope ***/
+//The size, in bytes, at which the text editor switches a note from a GapBuffer to a Rope
+const int ROPE_THRESHOLD = 1024 * 1024;
+//The most characters stored in a single leaf of a Rope
+const int ROPE_LEAF_SIZE = 1024;
+
+/*** AutosaveWorker ***/
+//How long, in milliseconds, the text editor waits after the last edit before saving the note in the background
+const int AUTOSAVE_IDLE_MS = 2000;
+//The number of edits after which the note is saved in the background, even if the user is still typing
+const int AUTOSAVE_EDIT_COUNT = 200;
+
+/*** NoteCache ***/
+//The maximum number of bytes of note text kept by the cache of notes read ahead of being opened
+const size_t NOTE_CACHE_BUDGET = 16 * 1024 * 1024;
+
+//The most notes waiting to be read ahead. Past this, the oldest request is dropped
+const int NOTE_PREFETCH_QUEUE_SIZE = 32;
+
 /*** Node ***/
 //The base color of a node, when not selected or hovered over
 const SDL_Color NODE_BASE_COLOR = { 0, 0, 0, 255 };
@@ -86,12 +175,100 @@ const int NODE_SIZE_INCREASE = 8;
 //The base width of a node (when not hovered/selected)
 const int NODE_WIDTH = 25; //Note: node width and height are same, they are squares.
 
+//The x and y position of a node that isn't in the graph's nbg file
+const int DEFAULT_NODE_POS = 100;
+
 //The path that all graphs will be stored in this program
 const std::string GRAPH_PATH = "Graphs/";
 
 //The path that all graphs will be stored in this program
 const std::string GRAPH_DATA_PATH = "graph_data.nbg";
 
+//The path of the journal of changes made to a graph since its nbg file was saved
+const std::string GRAPH_JOURNAL_PATH = "graph_data.nbj";
+
+/*** GraphFile ***/
+//The first bytes of a binary nbg file. Older nbg files are text, and never start with these
+const char GRAPH_FILE_MAGIC[4] = { 'N', 'B', 'G', 'F' };
+
+//The version of the binary nbg format written by this program
+const int GRAPH_FILE_VERSION = 1;
+
+/*** GraphJournal ***/
+//The first bytes of a graph's journal
+const char GRAPH_JOURNAL_MAGIC[4] = { 'N', 'B', 'G', 'J' };
+
+//The version of the journal format written by this program
+const int GRAPH_JOURNAL_VERSION = 1;
+
+//The size, in bytes, a journal can grow to before it's compacted into a new nbg file
+const size_t JOURNAL_COMPACT_SIZE = 1024 * 1024;
+
+/*** PackedStorage ***/
+//The name of the container file holding every note of a packed graph
+const std::string PACKED_NOTES_PATH = "notes.nbp";
+
+//The first bytes of a container file
+const char PACKED_FILE_MAGIC[4] = { 'N', 'B', 'G', 'P' };
+
+//The version of the container format written by this program
+const int PACKED_FILE_VERSION = 1;
+
+//Every slot in a container is a multiple of this many bytes, so freed slots are easier to reuse
+const Uint64 PACKED_SLOT_ALIGN = 64;
+
+//A container is compacted when it's closed, if at least this many bytes of it are free...
+const Uint64 PACKED_COMPACT_MIN_FREE = 4 * 1024 * 1024;
+
+//...and at least this much of it is free
+const double PACKED_COMPACT_RATIO = 0.5;
+
+//Indicates that new graphs keep their notes in one container file, instead of a file for each note
+const bool PACK_NEW_GRAPHS = false;
+
+/*** ConnectionStore ***/
+//The color of the lines drawn between connected nodes
+const SDL_Color CONNECTION_COLOR = { 90, 60, 90, 255 };
+
+//The width, in pixels, of the lines drawn between connected nodes
+const int CONNECTION_WIDTH = 2;
+
+//Connections spanning more than this, in world units across or down, are checked every frame. Shorter connections are
+//only found through the nodes around the view
+const int LONG_CONNECTION_LENGTH = 1024;
+
+//The text between the titles of two connected nodes in an older, text nbg file
+const std::string CONNECTION_SEPARATOR = "\t";
+
+/*** Camera ***/
+//The closest and farthest the graph can be zoomed. A zoom of 1 draws nodes at their real size
+const float CAMERA_MIN_ZOOM = 0.05f;
+const float CAMERA_MAX_ZOOM = 8.0f;
+
+//The amount the zoom is multiplied by for each notch of the mouse wheel
+const float CAMERA_ZOOM_STEP = 1.1f;
+
+/*** SpatialGrid ***/
+//The width and height of each cell in the grid used to find nodes by position. A few nodes wide works best
+const int SPATIAL_GRID_CELL_SIZE = 128;
+
+/*** Clusters ***/
+//The width and height of each cluster. When zoomed out, all the nodes centered in a cluster are drawn as one block
+const int CLUSTER_CELL_SIZE = 512;
+
+//Below this zoom, the graph is drawn as clusters instead of single nodes
+const float CLUSTER_ZOOM_THRESHOLD = 0.25f;
+
+//The number of shades clusters are drawn in. Each shade holds about twice as many nodes as the one before it
+const int CLUSTER_SHADE_COUNT = 8;
+
+//The color of the fullest clusters. Emptier clusters are drawn more transparent
+const SDL_Color CLUSTER_COLOR = NODE_BASE_COLOR;
+
+//The font size of the count drawn on each cluster, and the smallest width (on screen) a cluster needs to show it
+const int CLUSTER_FONT_SIZE = 20;
+const int CLUSTER_LABEL_MIN_WIDTH = 40;
+
 /*** PopupMenu and Children ***/
 //The basic color of menus
 const SDL_Color MENU_BACKGROUND_COLOR = NODE_SELECTED_COLOR;
@@ -123,3 +300,7 @@ const int MENU_TEXT_INPUT_FONT_SIZE = 20;
 //The vertical space between buttons in TextMenu
 const int MENU_TEXT_INPUT_HEIGHT = MENU_TEXT_INPUT_FONT_SIZE + 10;
 
+/*** FontPool ***/
+//Every font size used by this program. FontPool opens each of these when it's created
+const int FONT_POOL_SIZES[] = { HEADER_FONT_SIZE, CONTENT_FONT_SIZE, MENU_MESSAGE_FONT_SIZE, MENU_BUTTON_FONT_SIZE, MENU_TEXT_INPUT_FONT_SIZE, CLUSTER_FONT_SIZE, LOAD_FONT_SIZE };
+
@@ -0,0 +1,279 @@
+//Author: Connor Kamrowski. See header file for more information.
+#include "ConnectionStore.h"
+
+//Add the connection to the array, and to the lists of both nodes.
+bool ConnectionStore::connect(NodeId a, NodeId b) {
+	if (a == b || a < 0 || b < 0 || isConnected(a, b)) {
+		return false;
+	}
+
+	int needed = std::max(a, b) + 1;
+	if ((int)node_connections.size() < needed) {
+		node_connections.resize(needed);
+	}
+
+	int index = (int)connections.size();
+	connections.push_back({ a, b });
+	long_places.push_back(-1);
+	queued_frame.push_back(0);
+	node_connections[a].push_back(index);
+	node_connections[b].push_back(index);
+	classify(index);
+
+	return true;
+}
+
+//Only the node's own connections can have changed length.
+void ConnectionStore::nodeMoved(NodeId id) {
+	if (id < 0 || id >= (int)node_connections.size()) {
+		return;
+	}
+
+	for (int index : node_connections[id]) {
+		classify(index);
+	}
+}
+
+//Find the connection, then remove it.
+bool ConnectionStore::disconnect(NodeId a, NodeId b) {
+	int index = find(a, b);
+	if (index == -1) {
+		return false;
+	}
+
+	removeAt(index);
+	return true;
+}
+
+//Remove the node's connections one at a time, from the end of its list, then free the list.
+void ConnectionStore::removeNode(NodeId id) {
+	if (id < 0 || id >= (int)node_connections.size()) {
+		return;
+	}
+
+	while (!node_connections[id].empty()) {
+		removeAt(node_connections[id].back());
+	}
+
+	std::vector<int>().swap(node_connections[id]);
+}
+
+//The neighbor is whichever end of each connection isn't the node.
+void ConnectionStore::getNeighbors(NodeId id, std::vector<NodeId>& out) const {
+	out.clear();
+	if (id < 0 || id >= (int)node_connections.size()) {
+		return;
+	}
+
+	for (int index : node_connections[id]) {
+		const Connection& connection = connections[index];
+		out.push_back(connection.a == id ? connection.b : connection.a);
+	}
+}
+
+//Swap every array with an empty one, so their memory is freed.
+void ConnectionStore::clear() {
+	std::vector<Connection>().swap(connections);
+	std::vector<std::vector<int>>().swap(node_connections);
+	std::vector<int>().swap(long_connections);
+	std::vector<int>().swap(long_places);
+	std::vector<unsigned int>().swap(queued_frame);
+	std::vector<NodeId>().swap(nearby);
+	std::vector<SDL_Vertex>().swap(vertices);
+}
+
+/**
+ * Each connection is drawn as a quad (two triangles) CONNECTION_WIDTH pixels wide, so every connection can be drawn
+ * in a single SDL_RenderGeometry call. A short connection crossing the view has both of its nodes within
+ * LONG_CONNECTION_LENGTH of the view, so only the connections of those nodes, and the long connections, are checked.
+ * Panning and zooming then costs the connections near the view, not every connection in the graph.
+ */
+void ConnectionStore::render(SDL_Renderer* renderer, SpatialGrid& grid, const Camera& camera, const SDL_Rect& view) {
+	vertices.clear();
+	frame++;
+
+	for (int index : long_connections) {
+		queueConnection(index, camera, view);
+	}
+
+	SDL_Rect around = { view.x - LONG_CONNECTION_LENGTH, view.y - LONG_CONNECTION_LENGTH,
+		view.w + LONG_CONNECTION_LENGTH * 2, view.h + LONG_CONNECTION_LENGTH * 2 };
+	grid.queryRect(around, nearby);
+
+	for (NodeId id : nearby) {
+		if (id >= (int)node_connections.size()) {
+			continue;
+		}
+
+		for (int index : node_connections[id]) {
+			queueConnection(index, camera, view);
+		}
+	}
+
+	if (!vertices.empty()) {
+		SDL_RenderGeometry(renderer, nullptr, vertices.data(), (int)vertices.size(), nullptr, 0);
+	}
+
+}//END OF render()
+
+//Skip the connection if it was already queued this frame, or if the box around it doesn't touch the view.
+void ConnectionStore::queueConnection(int index, const Camera& camera, const SDL_Rect& view) {
+	if (queued_frame[index] == frame) {
+		return;
+	}
+	queued_frame[index] = frame;
+
+	const Connection& connection = connections[index];
+	SDL_Rect shape_a = nodes->getShape(connection.a);
+	SDL_Rect shape_b = nodes->getShape(connection.b);
+
+	//The centers of the two nodes
+	int ax = shape_a.x + shape_a.w / 2;
+	int ay = shape_a.y + shape_a.h / 2;
+	int bx = shape_b.x + shape_b.w / 2;
+	int by = shape_b.y + shape_b.h / 2;
+
+	//Skip the connection if it can't cross the view
+	if (std::max(ax, bx) < view.x || std::min(ax, bx) > view.x + view.w
+		|| std::max(ay, by) < view.y || std::min(ay, by) > view.y + view.h) {
+		return;
+	}
+
+	float sx_a, sy_a, sx_b, sy_b;
+	camera.worldToScreen(ax, ay, &sx_a, &sy_a);
+	camera.worldToScreen(bx, by, &sx_b, &sy_b);
+
+	//Offset the ends sideways, perpendicular to the connection, by half of its width
+	float half_width = CONNECTION_WIDTH / 2.0f;
+	float dx = sx_b - sx_a;
+	float dy = sy_b - sy_a;
+	float length = std::sqrt(dx * dx + dy * dy);
+	if (length < 1) {
+		return;
+	}
+
+	float ox = -dy / length * half_width;
+	float oy = dx / length * half_width;
+
+	SDL_Vertex corners[4] = {
+		{ { sx_a + ox, sy_a + oy }, CONNECTION_COLOR, { 0, 0 } },
+		{ { sx_a - ox, sy_a - oy }, CONNECTION_COLOR, { 0, 0 } },
+		{ { sx_b + ox, sy_b + oy }, CONNECTION_COLOR, { 0, 0 } },
+		{ { sx_b - ox, sy_b - oy }, CONNECTION_COLOR, { 0, 0 } }
+	};
+
+	//two triangles make the quad
+	vertices.push_back(corners[0]);
+	vertices.push_back(corners[1]);
+	vertices.push_back(corners[2]);
+	vertices.push_back(corners[2]);
+	vertices.push_back(corners[1]);
+	vertices.push_back(corners[3]);
+
+}//END OF queueConnection()
+
+/**
+ * Measure the connection between the centers of its nodes. A long connection is added to the end of the list, and
+ * removed by moving the last one into its place.
+ */
+void ConnectionStore::classify(int index) {
+	const Connection& connection = connections[index];
+	bool is_long = false;
+
+	if (nodes != nullptr) {
+		SDL_Rect shape_a = nodes->getShape(connection.a);
+		SDL_Rect shape_b = nodes->getShape(connection.b);
+		int dx = std::abs((shape_a.x + shape_a.w / 2) - (shape_b.x + shape_b.w / 2));
+		int dy = std::abs((shape_a.y + shape_a.h / 2) - (shape_b.y + shape_b.h / 2));
+		is_long = dx > LONG_CONNECTION_LENGTH || dy > LONG_CONNECTION_LENGTH;
+	}
+
+	int place = long_places[index];
+	if (is_long && place == -1) {
+		long_places[index] = (int)long_connections.size();
+		long_connections.push_back(index);
+	}
+	else if (!is_long && place != -1) {
+		int last = long_connections.back();
+		long_connections[place] = last;
+		long_places[last] = place;
+		long_connections.pop_back();
+		long_places[index] = -1;
+	}
+}
+
+//Look through the list of whichever node has fewer connections.
+int ConnectionStore::find(NodeId a, NodeId b) const {
+	//A node is never connected to itself
+	if (a == b || a < 0 || b < 0 || a >= (int)node_connections.size() || b >= (int)node_connections.size()) {
+		return -1;
+	}
+
+	NodeId smaller = (node_connections[a].size() <= node_connections[b].size()) ? a : b;
+	NodeId other = (smaller == a) ? b : a;
+
+	for (int index : node_connections[smaller]) {
+		const Connection& connection = connections[index];
+		if (connection.a == other || connection.b == other) {
+			return index;
+		}
+	}
+
+	return -1;
+}
+
+/**
+ * Remove the connection from both of its nodes' lists, then fill its place with the last connection. The last
+ * connection's nodes are told its new place, so every list stays correct.
+ */
+void ConnectionStore::removeAt(int index) {
+	Connection removed = connections[index];
+	replaceIn(removed.a, index, -1);
+	replaceIn(removed.b, index, -1);
+
+	//take it out of the long connections, if it's there
+	if (long_places[index] != -1) {
+		int place = long_places[index];
+		int moved = long_connections.back();
+		long_connections[place] = moved;
+		long_places[moved] = place;
+		long_connections.pop_back();
+	}
+
+	int last = (int)connections.size() - 1;
+	if (index != last) {
+		connections[index] = connections[last];
+		long_places[index] = long_places[last];
+		queued_frame[index] = queued_frame[last];
+		replaceIn(connections[index].a, last, index);
+		replaceIn(connections[index].b, last, index);
+
+		if (long_places[index] != -1) {
+			long_connections[long_places[index]] = index;
+		}
+	}
+
+	connections.pop_back();
+	long_places.pop_back();
+	queued_frame.pop_back();
+}
+
+//Find old_index in the node's list and replace it. A new_index of -1 removes it instead.
+void ConnectionStore::replaceIn(NodeId id, int old_index, int new_index) {
+	std::vector<int>& list = node_connections[id];
+
+	for (int i = 0; i < (int)list.size(); i++) {
+		if (list[i] != old_index) {
+			continue;
+		}
+
+		if (new_index == -1) {
+			list[i] = list.back();
+			list.pop_back();
+		}
+		else {
+			list[i] = new_index;
+		}
+		return;
+	}
+}
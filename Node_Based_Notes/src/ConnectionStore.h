@@ -0,0 +1,161 @@
+/*
+ * ConnectionStore holds the connections between the nodes of a graph. A connection links two nodes, in no particular
+ * direction, and a pair of nodes is connected at most once.
+ *
+ * Every connection is kept in one array, which is what gets drawn and saved. Each node also has a list of the places
+ * its connections are kept in that array, so finding a node's neighbors, or removing a connection, only looks at that
+ * node's connections instead of all of them. Removing a connection moves the last one into its place, so the array
+ * never has gaps.
+ *
+ * Connections are drawn as thin quads in one SDL_RenderGeometry call. Drawing doesn't look at every connection: the
+ * connections of the nodes in and around the view are found through the SpatialGrid. Only connections longer than
+ * LONG_CONNECTION_LENGTH can cross the view without either node being near it, so those are kept in a list of their
+ * own that's always checked. A connection is sorted into that list when it's made, and again when one of its nodes
+ * moves.
+ *
+ * Author: Connor Kamrowski
+ */
+#pragma once
+#include "Config.h"
+#include "NodeStore.h"
+#include "SpatialGrid.h"
+
+//A connection between two nodes
+struct Connection {
+	NodeId a;
+	NodeId b;
+};
+
+class ConnectionStore {
+public:
+	/**
+	 * Connect two nodes.
+	 *
+	 * \param a: One of the nodes
+	 * \param b: The other node
+	 * \return true if the connection was made, false if a and b are the same or were already connected
+	 */
+	bool connect(NodeId a, NodeId b);
+
+	/**
+	 * Set the NodeStore holding the connected nodes, used to find the length of each connection.
+	 * \param store: The nodes being connected
+	 */
+	void setNodes(const NodeStore* store) { nodes = store; }
+
+	/**
+	 * Sort a node's connections by length again, after the node moved or changed size.
+	 *
+	 * \param id: The node that moved
+	 */
+	void nodeMoved(NodeId id);
+
+	/**
+	 * Remove the connection between two nodes.
+	 *
+	 * \return true if there was a connection to remove
+	 */
+	bool disconnect(NodeId a, NodeId b);
+
+	/**
+	 * \return true if the two nodes are connected.
+	 */
+	bool isConnected(NodeId a, NodeId b) const { return find(a, b) != -1; }
+
+	/**
+	 * Remove every connection of a node. Called before the node is removed from its NodeStore.
+	 *
+	 * \param id: The node being removed
+	 */
+	void removeNode(NodeId id);
+
+	/**
+	 * Find every node connected to a node.
+	 *
+	 * \param id: The node to look at
+	 * \param out: The vector the neighbors are written to. Its previous contents are cleared
+	 */
+	void getNeighbors(NodeId id, std::vector<NodeId>& out) const;
+
+	/**
+	 * \return The number of connections a node has.
+	 */
+	int getDegree(NodeId id) const { return id < (int)node_connections.size() ? (int)node_connections[id].size() : 0; }
+
+	/**
+	 * \return Every connection, in no particular order.
+	 */
+	const std::vector<Connection>& getConnections() const { return connections; }
+
+	/**
+	 * \return The number of connections.
+	 */
+	int size() const { return (int)connections.size(); }
+
+	/**
+	 * Remove every connection, freeing their memory.
+	 */
+	void clear();
+
+	/**
+	 * Draw every connection that crosses the view, from the center of one node to the center of the other.
+	 *
+	 * \param renderer: The SDL_Renderer* being used
+	 * \param grid: The SpatialGrid holding the nodes, to find the nodes around the view
+	 * \param camera: The Camera used to convert positions in the graph to the screen
+	 * \param view: The area of the graph the camera can see, in world coordinates
+	 */
+	void render(SDL_Renderer* renderer, SpatialGrid& grid, const Camera& camera, const SDL_Rect& view);
+
+private:
+	/**
+	 * \return The place of the connection between a and b in 'connections', or -1 if they aren't connected.
+	 */
+	int find(NodeId a, NodeId b) const;
+
+	/**
+	 * Remove a connection by its place in 'connections', moving the last connection into its place.
+	 */
+	void removeAt(int index);
+
+	/**
+	 * Replace one place with another in a node's list of connections.
+	 */
+	void replaceIn(NodeId id, int old_index, int new_index);
+
+	/**
+	 * Add a connection to 'long_connections' if it's longer than LONG_CONNECTION_LENGTH, or take it out if it isn't.
+	 */
+	void classify(int index);
+
+	/**
+	 * Queue the quad of a connection, if it crosses the view and hasn't been queued yet this frame.
+	 */
+	void queueConnection(int index, const Camera& camera, const SDL_Rect& view);
+
+	//Every connection
+	std::vector<Connection> connections;
+
+	//The places in 'connections' of each node's connections, indexed by NodeId
+	std::vector<std::vector<int>> node_connections;
+
+	//The places in 'connections' of every connection longer than LONG_CONNECTION_LENGTH
+	std::vector<int> long_connections;
+
+	//The place of each connection in 'long_connections', or -1 if it's short. Indexed like 'connections'
+	std::vector<int> long_places;
+
+	//The frame each connection was last queued in, so a connection found through both of its nodes is drawn once
+	std::vector<unsigned int> queued_frame;
+	unsigned int frame = 0;
+
+	//The nodes being connected
+	const NodeStore* nodes = nullptr;
+
+	//The nodes around the view. Kept between frames so the memory is reused
+	std::vector<NodeId> nearby;
+
+	//The corners of the quads drawn for each connection. Kept between frames so the memory is reused
+	std::vector<SDL_Vertex> vertices;
+
+};
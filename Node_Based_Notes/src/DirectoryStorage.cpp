@@ -0,0 +1,69 @@
+//Author: Connor Kamrowski. See header file for more information.
+#include "DirectoryStorage.h"
+
+#include <filesystem>
+namespace fs = std::filesystem;
+
+//Read the whole file at once.
+bool DirectoryStorage::read(const std::string& path, std::string& out) {
+	return FileIO::readFile(path, out);
+}
+
+//Replace the file atomically, so a failed save leaves the old note.
+bool DirectoryStorage::write(const std::string& path, const TextSnapshot& text) {
+	return FileIO::writeFileAtomic(path, text);
+}
+
+bool DirectoryStorage::exists(const std::string& path) {
+	std::error_code error;
+	return fs::exists(path, error);
+}
+
+bool DirectoryStorage::remove(const std::string& path) {
+	std::error_code error;
+	return fs::remove(path, error);
+}
+
+bool DirectoryStorage::rename(const std::string& old_path, const std::string& new_path) {
+	return std::rename(old_path.c_str(), new_path.c_str()) == 0;
+}
+
+/**
+ * List the .txt files in the directory. The title of each note is the name of its file, without the '.txt'.
+ */
+bool DirectoryStorage::list(const std::function<bool(std::string&&)>& found) {
+	std::error_code error;
+
+	fs::directory_iterator entry(graph_path, error);
+	for (; !error && entry != fs::directory_iterator(); entry.increment(error)) {
+		//If it isn't a .txt file, then skip it
+		if (entry->path().extension().string() != ".txt") {
+			continue;
+		}
+
+		if (!found(entry->path().stem().string())) {
+			return true;
+		}
+	}
+
+	if (error) {
+		std::cout << "ERROR: The graph's directory could not be read. Path: " << graph_path << std::endl;
+		return false;
+	}
+
+	return true;
+
+}//END OF list()
+
+//List the notes first, so the directory isn't changed while it's being listed.
+bool DirectoryStorage::clear() {
+	std::vector<std::string> titles;
+	bool listed = list([&](std::string&& title) { titles.push_back(std::move(title)); return true; });
+
+	bool removed = true;
+	for (const std::string& title : titles) {
+		removed = remove(graph_path + title + ".txt") && removed;
+	}
+
+	return listed && removed;
+}
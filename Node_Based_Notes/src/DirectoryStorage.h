@@ -0,0 +1,65 @@
+/*
+ * DirectoryStorage keeps each note of a graph in its own .txt file, in the graph's directory. Notes are read with
+ * FileIO::readFile and saved with FileIO::writeFileAtomic. It keeps no state of its own, so any thread can use it.
+ *
+ * Author: Connor Kamrowski
+ */
+#pragma once
+#include "Config.h"
+#include "NoteStorage.h"
+#include "FileIO.h"
+
+class DirectoryStorage : public NoteStorage {
+public:
+	/**
+	 * DirectoryStorage constructor.
+	 *
+	 * \param graph_path: The path of the graph's directory, ending in '/'
+	 */
+	DirectoryStorage(const std::string& graph_path) : graph_path(graph_path) {}
+
+	/**
+	 * Read the note's file. Windows line endings are changed to "\n".
+	 */
+	bool read(const std::string& path, std::string& out);
+
+	/**
+	 * Save the note's file, replacing it in one step.
+	 */
+	bool write(const std::string& path, const TextSnapshot& text);
+
+	/**
+	 * \return true if the note's file exists.
+	 */
+	bool exists(const std::string& path);
+
+	/**
+	 * Delete the note's file.
+	 */
+	bool remove(const std::string& path);
+
+	/**
+	 * Rename the note's file.
+	 */
+	bool rename(const std::string& old_path, const std::string& new_path);
+
+	/**
+	 * List the .txt files in the graph's directory.
+	 */
+	bool list(const std::function<bool(std::string&&)>& found);
+
+	/**
+	 * Delete every .txt file in the graph's directory. Anything else in it, like the nbg file, is kept.
+	 */
+	bool clear();
+
+	/**
+	 * \return false, each note is its own file.
+	 */
+	bool isPacked() const { return false; }
+
+private:
+	//The path of the graph's directory
+	std::string graph_path;
+
+};
@@ -0,0 +1,150 @@
+//Author: Connor Kamrowski. See header file for more information.
+#include "FileIO.h"
+
+#include <filesystem>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+/**
+ * Read a whole file at once. The file is opened in binary mode so its size on disk matches the number of characters
+ * read, then the line endings of text are fixed afterwards in one pass.
+ */
+bool FileIO::readFile(const std::string& path, std::string& out, bool binary) {
+	out.clear();
+
+	//Open the file at the end, so its size is known right away
+	std::ifstream file(path, std::ifstream::binary | std::ifstream::ate);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	std::streamoff size = file.tellg();
+	if (size < 0) {
+		return false;
+	}
+
+	//size the string once, and read straight into it
+	out.resize((size_t)size);
+	file.seekg(0, std::ifstream::beg);
+
+	if (size > 0 && !file.read(&out[0], size)) {
+		out.clear();
+		return false;
+	}
+
+	if (!binary) {
+		normalizeLineEndings(out);
+	}
+
+	return true;
+
+}//END OF readFile()
+
+/**
+ * Write the text to a temporary file, make sure it's really on the disk, then rename it over the old file. A rename
+ * within a directory either happens completely or not at all, so the note is always either the old or the new text.
+ */
+bool FileIO::writeFileAtomic(const std::string& path, const TextSnapshot& text, bool binary) {
+	std::string temp_path = path + ".tmp";
+
+	//Text mode, so line breaks are written the same way they always have been
+	FILE* file = openFile(temp_path, binary ? "wb" : "w");
+	if (file == nullptr) {
+		return false;
+	}
+
+	bool written = text.write(file);
+	written = syncFile(file) && written;
+	written = (fclose(file) == 0) && written;
+
+	//replace the old file with the new one, or throw the new one away if anything went wrong
+	std::error_code error;
+	if (written) {
+		std::filesystem::rename(temp_path, path, error);
+	}
+
+	if (!written || error) {
+		std::filesystem::remove(temp_path, error);
+		return false;
+	}
+
+	return true;
+
+}//END OF writeFileAtomic()
+
+/**
+ * Open the file for appending, so every write goes to its end, then sync it. Used for journals, which are only ever
+ * added to, so a write that's cut off only loses the bytes it was adding.
+ */
+bool FileIO::appendFile(const std::string& path, const std::string& bytes) {
+	FILE* file = openFile(path, "ab");
+	if (file == nullptr) {
+		return false;
+	}
+
+	bool written = fwrite(bytes.data(), 1, bytes.length(), file) == bytes.length();
+	written = syncFile(file) && written;
+	written = (fclose(file) == 0) && written;
+
+	return written;
+}
+
+//Open a file, avoiding the deprecated fopen on Windows.
+FILE* FileIO::openFile(const std::string& path, const char* mode) {
+	FILE* file = nullptr;
+
+#ifdef _WIN32
+	if (fopen_s(&file, path.c_str(), mode) != 0) {
+		return nullptr;
+	}
+#else
+	file = fopen(path.c_str(), mode);
+#endif
+
+	return file;
+}
+
+//Flush the C buffers into the operating system, then ask it to write them to the disk.
+bool FileIO::syncFile(FILE* file) {
+	if (fflush(file) != 0) {
+		return false;
+	}
+
+#ifdef _WIN32
+	return _commit(_fileno(file)) == 0;
+#else
+	return fsync(fileno(file)) == 0;
+#endif
+}
+
+//fseek takes a long, which is only 32 bits on Windows, so use the 64 bit version on each system.
+bool FileIO::seekFile(FILE* file, Uint64 offset) {
+#ifdef _WIN32
+	return _fseeki64(file, (__int64)offset, SEEK_SET) == 0;
+#else
+	return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+//Drop the '\r' from every "\r\n", keeping a read index and a write index into the same string.
+void FileIO::normalizeLineEndings(std::string& text) {
+	//Most notes were written on this machine in text mode, so check before doing any work
+	if (text.find('\r') == std::string::npos) {
+		return;
+	}
+
+	size_t write = 0;
+	for (size_t read = 0; read < text.length(); read++) {
+		if (text[read] == '\r' && read + 1 < text.length() && text[read + 1] == '\n') {
+			continue;
+		}
+
+		text[write++] = text[read];
+	}
+
+	text.resize(write);
+}
@@ -0,0 +1,80 @@
+/*
+ * FileIO is a collection of static functions for moving whole files between the disk and memory. Notes are read with
+ * a single bulk read into a buffer sized from the file, instead of one character at a time.
+ *
+ * Notes are saved atomically: the text is written to a temporary file next to the note, flushed all the way to the
+ * disk, and then renamed over the note. If the program or computer dies partway through, the old note is untouched.
+ *
+ * Author: Connor Kamrowski
+ */
+#pragma once
+#include "Config.h"
+#include "TextDocument.h"
+
+class FileIO {
+public:
+	/**
+	 * Read a whole file into a string. The string is sized to the file before reading, so it's filled by one read
+	 * without growing. Windows line endings ("\r\n") are changed to "\n", matching a file read in text mode.
+	 *
+	 * \param path: The path of the file to read
+	 * \param out: The string the file is read into. Its previous contents are replaced
+	 * \param binary: If true, the bytes are read exactly as they are, without changing the line endings
+	 * \return false if the file couldn't be opened or read
+	 */
+	static bool readFile(const std::string& path, std::string& out, bool binary = false);
+
+	/**
+	 * Save text to a file without ever leaving it half-written. The text goes to "<path>.tmp" first, which is synced
+	 * to the disk and then renamed to path, replacing the old file in one step.
+	 *
+	 * \param path: The path of the file to write
+	 * \param text: The text to write into the file
+	 * \param binary: If true, the bytes are written exactly as they are, without changing the line endings
+	 * \return false if the file couldn't be written. The file at path is left as it was
+	 */
+	static bool writeFileAtomic(const std::string& path, const TextSnapshot& text, bool binary = false);
+
+	/**
+	 * Add bytes to the end of a file, creating it if it doesn't exist, and wait for them to be written to the disk.
+	 *
+	 * \param path: The path of the file to add to
+	 * \param bytes: The bytes to add, written exactly as they are
+	 * \return false if the bytes couldn't all be written and synced
+	 */
+	static bool appendFile(const std::string& path, const std::string& bytes);
+
+	/**
+	 * Remove each carriage return that comes right before a line break, shifting the text down in place.
+	 *
+	 * \param text: The text to change
+	 */
+	static void normalizeLineEndings(std::string& text);
+
+	/**
+	 * Open a file with fopen, or fopen_s on Windows.
+	 *
+	 * \param path: The path of the file to open
+	 * \param mode: The fopen mode to open it with
+	 * \return The opened FILE*, or nullptr if it couldn't be opened
+	 */
+	static FILE* openFile(const std::string& path, const char* mode);
+
+	/**
+	 * Flush a file's buffers, then wait for the operating system to write it to the disk.
+	 *
+	 * \param file: The FILE* to sync
+	 * \return false if the file couldn't be synced
+	 */
+	static bool syncFile(FILE* file);
+
+	/**
+	 * Move to a position in a file, which may be past 2GB.
+	 *
+	 * \param file: The FILE* to move in
+	 * \param offset: The number of bytes from the start of the file
+	 * \return false if the position couldn't be moved to
+	 */
+	static bool seekFile(FILE* file, Uint64 offset);
+
+};
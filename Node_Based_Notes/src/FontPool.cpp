@@ -0,0 +1,57 @@
+//Author: Connor Kamrowski. See header file for more information.
+#include "FontPool.h"
+
+/**
+ * The FontPool constructor. Open the font at every size that is used by this program, so none of them have to be
+ * opened while drawing.
+ */
+FontPool::FontPool(const std::string& font_filename, const int* sizes, int num_sizes) {
+	filename = font_filename;
+
+	for (int i = 0; i < num_sizes; i++) {
+		getEntry(sizes[i]);
+	}
+}
+
+/**
+ * The FontPool deconstructor. Close every font that was opened.
+ */
+FontPool::~FontPool() {
+	for (auto& entry : fonts) {
+		TTF_CloseFont(entry.second->font);
+		delete entry.second;
+	}
+
+	fonts.clear();
+}
+
+//Lock the font for the given size, and pass it back through 'font'.
+std::unique_lock<std::mutex> FontPool::acquire(int font_size, TTF_Font** font) {
+	Entry* entry = getEntry(font_size);
+
+	std::unique_lock<std::mutex> font_lock(entry->lock);
+	*font = entry->font;
+
+	return font_lock;
+}
+
+//Find the font for the given size, or open it if this size hasn't been used.
+FontPool::Entry* FontPool::getEntry(int font_size) {
+	std::lock_guard<std::mutex> guard(pool_lock);
+
+	auto found = fonts.find(font_size);
+	if (found != fonts.end()) {
+		return found->second;
+	}
+
+	Entry* entry = new Entry();
+	entry->font = TTF_OpenFont(filename.c_str(), font_size);
+	if (entry->font == NULL) {
+		std::cout << "TTF Font could not be loaded. Error info: " << TTF_GetError() << std::endl;
+		exit(0);
+	}
+
+	fonts[font_size] = entry;
+
+	return entry;
+}
@@ -0,0 +1,65 @@
+/*
+ * FontPool keeps one open TTF_Font for each font size, instead of a single font that is resized before every draw.
+ * Resizing a font throws away FreeType's cached glyphs, so with several sizes on screen every frame, the caches were
+ * being flushed over and over.
+ *
+ * The sizes listed in FONT_POOL_SIZES (Config.h) are opened when the pool is created. Any other size is opened the
+ * first time it is used. Each font has its own lock, so fonts can be borrowed from worker threads that rasterize
+ * text, as long as they hold the lock returned by acquire().
+ *
+ * Author: Connor Kamrowski
+ */
+#pragma once
+#include "Config.h"
+
+#include <mutex>
+#include <unordered_map>
+
+class FontPool {
+public:
+	/**
+	 * FontPool constructor. Opens the font file once for each of the given sizes.
+	 *
+	 * \param font_filename: The path to the .ttf file used by every font in the pool
+	 * \param sizes: The font sizes to open right away
+	 * \param num_sizes: The number of sizes in 'sizes'
+	 */
+	FontPool(const std::string& font_filename, const int* sizes, int num_sizes);
+
+	/**
+	 * FontPool deconstructor. Closes every font. This must happen before TTF_Quit().
+	 */
+	~FontPool();
+
+	/**
+	 * Borrow the font for a size, opening it if it hasn't been used before. The font is locked for as long as the
+	 * returned lock is held, so two threads never render with the same TTF_Font at once.
+	 *
+	 * \param font_size: The font size needed
+	 * \param font: Set to the TTF_Font* for font_size
+	 * \return A lock on the font, which should be held while the font is in use
+	 */
+	std::unique_lock<std::mutex> acquire(int font_size, TTF_Font** font);
+
+private:
+	//An open font, and the lock guarding it
+	struct Entry {
+		TTF_Font* font = nullptr;
+		std::mutex lock;
+	};
+
+	/**
+	 * Find the entry for a font size, opening the font if it isn't in the pool yet.
+	 */
+	Entry* getEntry(int font_size);
+
+	//The path to the .ttf file
+	std::string filename;
+
+	//Guards 'fonts', so sizes can be added from any thread
+	std::mutex pool_lock;
+
+	//The entry for each open font size, with the font size as the key
+	std::unordered_map<int, Entry*> fonts;
+
+};
@@ -0,0 +1,99 @@
+//Author: Connor Kamrowski. See header file for more information.
+#include "GapBuffer.h"
+
+/**
+ * The GapBuffer constructor. Start with an empty gap, it's grown on the first insert.
+ */
+GapBuffer::GapBuffer() {}
+
+//Replace the text, leaving the gap (and cursor) at the end so typing at the end of a note is immediate.
+void GapBuffer::assign(const char* text, int count) {
+	buffer.assign(text, text + count);
+	buffer.resize(count + GAP_BUFFER_MIN_GAP);
+
+	gap_start = count;
+	gap_end = (int)buffer.size();
+
+	cursor = anchor = count;
+}
+
+//Copy a range of the text, which may be split by the gap, into a string.
+void GapBuffer::copy(int start, int count, std::string& out) const {
+	out.clear();
+
+	//The part of the range before the gap
+	if (start < gap_start) {
+		int before_gap = std::min(count, gap_start - start);
+		out.append(buffer.data() + start, before_gap);
+		start += before_gap;
+		count -= before_gap;
+	}
+
+	//The part of the range after the gap
+	if (count > 0) {
+		out.append(buffer.data() + start + gap_end - gap_start, count);
+	}
+}
+
+//Insert text, moving the gap to the insertion point first.
+void GapBuffer::insertAt(int position, const char* text, int count) {
+	moveGap(position);
+	reserveGap(count);
+
+	memcpy(buffer.data() + gap_start, text, count);
+	gap_start += count;
+}
+
+//Remove text by widening the gap over it.
+void GapBuffer::eraseAt(int position, int count) {
+	moveGap(position);
+	gap_end += count;
+}
+
+/**
+ * Move the gap to a new position. Characters between the old and new positions are shifted across the gap, so moving
+ * the gap a short distance (like typing after moving the cursor a few characters) is cheap.
+ */
+void GapBuffer::moveGap(int position) {
+	if (position < gap_start) {
+		//Move the characters before the gap to after it
+		int count = gap_start - position;
+		memmove(buffer.data() + gap_end - count, buffer.data() + position, count);
+		gap_start -= count;
+		gap_end -= count;
+	}
+	else if (position > gap_start) {
+		//Move the characters after the gap to before it
+		int count = position - gap_start;
+		memmove(buffer.data() + gap_start, buffer.data() + gap_end, count);
+		gap_start += count;
+		gap_end += count;
+	}
+}
+
+/**
+ * Grow the buffer if the gap is too small. The buffer at least doubles, so inserting is O(1) amortized.
+ */
+void GapBuffer::reserveGap(int needed) {
+	int gap_size = gap_end - gap_start;
+	if (gap_size >= needed) {
+		return;
+	}
+
+	int old_size = (int)buffer.size();
+	int new_size = std::max(old_size * 2, old_size - gap_size + needed + GAP_BUFFER_MIN_GAP);
+	int after_gap = old_size - gap_end;
+
+	//Move the text after the gap to the end of the larger buffer
+	buffer.resize(new_size);
+	memmove(buffer.data() + new_size - after_gap, buffer.data() + gap_end, after_gap);
+	gap_end = new_size - after_gap;
+}
+
+//Copy the text, around the gap, into a snapshot.
+std::shared_ptr<const TextSnapshot> GapBuffer::snapshot() const {
+	std::string text;
+	copy(0, length(), text);
+
+	return std::make_shared<StringSnapshot>(std::move(text));
+}
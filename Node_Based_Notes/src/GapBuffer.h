@@ -0,0 +1,85 @@
+/*
+ * GapBuffer is the text model used by the text menus, and by the text editor for all but very large notes. The text is
+ * stored in one array with a "gap" of unused space at the cursor, so typing or deleting at the cursor only fills or
+ * widens the gap instead of moving every character after it. Moving the cursor elsewhere moves the gap the next time
+ * text is edited there.
+ *
+ * The cursor and selection are indices into the text, kept by TextDocument, and are never stored in the text itself.
+ *
+ * Author: Connor Kamrowski
+ */
+#pragma once
+#include "TextDocument.h"
+
+class GapBuffer : public TextDocument {
+public:
+	/**
+	 * GapBuffer constructor. The buffer starts empty, with the cursor at 0.
+	 */
+	GapBuffer();
+
+	/**
+	 * Replace all of the text, and place the cursor at the end of it with nothing selected.
+	 *
+	 * \param text: The new text
+	 * \param count: The number of characters in text
+	 */
+	void assign(const char* text, int count);
+
+	/**
+	 * \return The number of characters in the text.
+	 */
+	int length() const { return (int)buffer.size() - (gap_end - gap_start); }
+
+	/**
+	 * \param position: The index of a character, from 0 to length() - 1
+	 * \return The character at position.
+	 */
+	char at(int position) const { return position < gap_start ? buffer[position] : buffer[position + gap_end - gap_start]; }
+
+	/**
+	 * Copy part of the text into a string.
+	 *
+	 * \param start: The index of the first character to copy
+	 * \param count: The number of characters to copy
+	 * \param out: The string the text is copied into. Its previous contents are replaced
+	 */
+	void copy(int start, int count, std::string& out) const;
+
+	/**
+	 * Copy the text into a snapshot. This copies every character, but only takes a single pass over the buffer.
+	 *
+	 * \return The snapshot
+	 */
+	std::shared_ptr<const TextSnapshot> snapshot() const;
+
+protected:
+	/**
+	 * Insert text at a position, without touching the cursor.
+	 */
+	void insertAt(int position, const char* text, int count);
+
+	/**
+	 * Remove text at a position, without touching the cursor.
+	 */
+	void eraseAt(int position, int count);
+
+private:
+	/**
+	 * Move the gap so it begins at position. Only the characters between the old and new gap are moved.
+	 */
+	void moveGap(int position);
+
+	/**
+	 * Make sure the gap can hold at least 'needed' characters, growing the buffer if it can't.
+	 */
+	void reserveGap(int needed);
+
+	//The text, with the gap of unused space somewhere inside
+	std::vector<char> buffer;
+
+	//The gap is buffer[gap_start, gap_end)
+	int gap_start = 0;
+	int gap_end = 0;
+
+};
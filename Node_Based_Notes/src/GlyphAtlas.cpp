@@ -0,0 +1,233 @@
+//Author: Connor Kamrowski. See header file for more information.
+#include "GlyphAtlas.h"
+
+/**
+ * The GlyphAtlas constructor. Render each glyph once, pack the glyphs into rows of a single surface, and upload
+ * that surface to a texture. The glyphs are rendered white, so any color can be applied when the quads are drawn.
+ */
+GlyphAtlas::GlyphAtlas(SDL_Renderer* renderer, TTF_Font* font) {
+	//The surfaces of each glyph, kept until they are copied into the atlas
+	SDL_Surface* glyph_surfaces[256] = { nullptr };
+
+	line_height = TTF_FontLineSkip(font);
+
+	//The position of the next glyph in the atlas, and the height of the current row of glyphs
+	int pen_x = GLYPH_ATLAS_PADDING;
+	int pen_y = GLYPH_ATLAS_PADDING;
+	int row_height = 0;
+
+	//Render every glyph and find its place in the atlas
+	for (int c = GLYPH_ATLAS_FIRST_CHAR; c <= GLYPH_ATLAS_LAST_CHAR; c++) {
+		//Skip any characters the font doesn't have, they will use the fallback glyph below
+		if (!TTF_GlyphIsProvided32(font, c)) {
+			continue;
+		}
+
+		int min_x, max_x, min_y, max_y;
+		TTF_GlyphMetrics32(font, c, &min_x, &max_x, &min_y, &max_y, &glyphs[c].advance);
+
+		//Spaces only move the pen, there's nothing to draw
+		if (c == ' ') {
+			continue;
+		}
+
+		glyph_surfaces[c] = TTF_RenderGlyph32_Blended(font, c, WHITE);
+		if (glyph_surfaces[c] == nullptr) {
+			continue;
+		}
+
+		//If the glyph doesn't fit in this row, start a new row
+		if (pen_x + glyph_surfaces[c]->w + GLYPH_ATLAS_PADDING > GLYPH_ATLAS_WIDTH) {
+			pen_x = GLYPH_ATLAS_PADDING;
+			pen_y += row_height + GLYPH_ATLAS_PADDING;
+			row_height = 0;
+		}
+
+		glyphs[c].source = { pen_x, pen_y, glyph_surfaces[c]->w, glyph_surfaces[c]->h };
+
+		pen_x += glyph_surfaces[c]->w + GLYPH_ATLAS_PADDING;
+		row_height = std::max(row_height, glyph_surfaces[c]->h);
+	}
+
+	texture_w = GLYPH_ATLAS_WIDTH;
+	texture_h = pen_y + row_height + GLYPH_ATLAS_PADDING;
+
+	//Create a transparent surface to hold every glyph
+	SDL_Surface* atlas_surface = SDL_CreateRGBSurfaceWithFormat(0, texture_w, texture_h, 32, SDL_PIXELFORMAT_RGBA32);
+	if (atlas_surface == nullptr) {
+		std::cout << "Glyph atlas could not be created. Error info: " << SDL_GetError() << std::endl;
+		exit(0);
+	}
+
+	//Copy each glyph into the atlas. Blending is disabled so the glyph's alpha is copied as-is
+	for (int c = 0; c < 256; c++) {
+		if (glyph_surfaces[c] == nullptr) {
+			continue;
+		}
+
+		SDL_SetSurfaceBlendMode(glyph_surfaces[c], SDL_BLENDMODE_NONE);
+		SDL_BlitSurface(glyph_surfaces[c], NULL, atlas_surface, &glyphs[c].source);
+
+		//free the glyph's surface, it lives in the atlas now
+		SDL_FreeSurface(glyph_surfaces[c]);
+	}
+
+	//Any character the font is missing is drawn as a question mark, except for control characters
+	for (int c = 0; c < 256; c++) {
+		if (glyphs[c].advance == 0 && c >= GLYPH_ATLAS_FIRST_CHAR) {
+			glyphs[c] = glyphs['?'];
+		}
+	}
+
+	//A tab is drawn as a few spaces
+	glyphs['\t'].advance = glyphs[' '].advance * TAB_WIDTH;
+
+	//upload the atlas, once, to the texture that all text at this size is drawn from
+	texture = SDL_CreateTextureFromSurface(renderer, atlas_surface);
+	SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+	SDL_FreeSurface(atlas_surface);
+
+}//END OF GlyphAtlas()
+
+/**
+ * The GlyphAtlas deconstructor. Destroy the texture holding the glyphs.
+ */
+GlyphAtlas::~GlyphAtlas() {
+	SDL_DestroyTexture(texture);
+}
+
+//Measure a string of text using the advance of each glyph.
+int GlyphAtlas::measureText(const char* text, int length) {
+	int width = 0;
+
+	for (int i = 0; i < length; i++) {
+		width += glyphs[(unsigned char)text[i]].advance;
+	}
+
+	return width;
+}
+
+/**
+ * Break text into lines that fit within container_width. This mirrors the wrapping done by
+ * TTF_RenderText_Blended_Wrapped, but only produces the line positions, so it can be reused without drawing.
+ */
+void GlyphAtlas::wrapText(const char* text, int length, int container_width, std::vector<TextLine>& lines) {
+	lines.clear();
+
+	//The first character of the current line, and the width of the line so far
+	int line_start = 0;
+	int line_width = 0;
+
+	//The index just after the last space on this line, where the line can be broken. -1 if there isn't one
+	int last_break = -1;
+
+	for (int i = 0; i < length; i++) {
+		unsigned char c = text[i];
+
+		//A line break always ends the line
+		if (c == '\n') {
+			pushLine(text, line_start, i, lines);
+			line_start = i + 1;
+			line_width = 0;
+			last_break = -1;
+			continue;
+		}
+
+		int advance = glyphs[c].advance;
+
+		//If this character doesn't fit on the line, wrap. Spaces are allowed to overflow, they're never drawn
+		if (container_width > 0 && line_width + advance > container_width && c != ' ' && i > line_start) {
+			if (last_break > line_start) {
+				//Break after the last space, and carry the rest of the word to the next line
+				pushLine(text, line_start, last_break, lines);
+				line_start = last_break;
+				line_width = measureText(text + line_start, i - line_start);
+			}
+			else {
+				//The word is wider than the container, break it where it overflows
+				pushLine(text, line_start, i, lines);
+				line_start = i;
+				line_width = 0;
+			}
+
+			last_break = -1;
+		}
+
+		line_width += advance;
+
+		if (c == ' ') {
+			last_break = i + 1;
+		}
+	}
+
+	//Add whatever is left as the last line
+	pushLine(text, line_start, length, lines);
+
+}//END OF wrapText()
+
+//Add a line to the vector of lines, measuring its width without any trailing spaces.
+void GlyphAtlas::pushLine(const char* text, int start, int end, std::vector<TextLine>& lines) {
+	TextLine line;
+	line.start = start;
+	line.length = end - start;
+
+	//trailing spaces aren't visible, so they don't count towards the width
+	int visible_end = end;
+	while (visible_end > start && text[visible_end - 1] == ' ') {
+		visible_end--;
+	}
+	line.width = measureText(text + start, visible_end - start);
+
+	lines.push_back(line);
+}
+
+/**
+ * Queue a quad for each character of text. The quads use the glyph's location in the atlas as texture coordinates,
+ * and are tinted using the vertex color.
+ */
+void GlyphAtlas::queueText(const char* text, int length, const SDL_Color* color, int x, int y) {
+	int pen_x = x;
+
+	for (int i = 0; i < length; i++) {
+		const Glyph& glyph = glyphs[(unsigned char)text[i]];
+
+		//Only queue the glyph if there's something to draw
+		if (glyph.source.w > 0) {
+			int first = (int)vertices.size();
+
+			//The corners of the quad on the screen, and in the atlas texture
+			float left = (float)pen_x;
+			float top = (float)y;
+			float right = left + glyph.source.w;
+			float bottom = top + glyph.source.h;
+
+			float u0 = (float)glyph.source.x / texture_w;
+			float v0 = (float)glyph.source.y / texture_h;
+			float u1 = (float)(glyph.source.x + glyph.source.w) / texture_w;
+			float v1 = (float)(glyph.source.y + glyph.source.h) / texture_h;
+
+			vertices.push_back({ { left, top }, *color, { u0, v0 } });
+			vertices.push_back({ { right, top }, *color, { u1, v0 } });
+			vertices.push_back({ { right, bottom }, *color, { u1, v1 } });
+			vertices.push_back({ { left, bottom }, *color, { u0, v1 } });
+
+			//two triangles make up the quad
+			indices.insert(indices.end(), { first, first + 1, first + 2, first, first + 2, first + 3 });
+		}
+
+		pen_x += glyph.advance;
+	}
+
+}//END OF queueText()
+
+//Draw every queued quad at once, and empty the batch for the next use.
+void GlyphAtlas::flush(SDL_Renderer* renderer) {
+	if (!indices.empty()) {
+		SDL_RenderGeometry(renderer, texture, vertices.data(), (int)vertices.size(), indices.data(), (int)indices.size());
+	}
+
+	//clear the batch, but keep the memory so the next frame doesn't have to allocate it again
+	vertices.clear();
+	indices.clear();
+}
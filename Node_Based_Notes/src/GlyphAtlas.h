@@ -0,0 +1,125 @@
+/*
+ * GlyphAtlas rasterizes the glyphs of a font once, at a single font size, into one shared SDL_Texture. Text is then
+ * drawn as a batch of textured quads cut out of that texture, instead of rendering a brand new SDL_Surface and
+ * SDL_Texture for every string, every frame.
+ *
+ * TextureManager keeps one GlyphAtlas per font size, and creates them the first time a size is used.
+ *
+ * Author: Connor Kamrowski
+ */
+#pragma once
+#include "Config.h"
+
+//The location of a single glyph within the atlas texture, and how far the pen moves after drawing it
+struct Glyph {
+	//The area of the atlas texture holding this glyph. A width of 0 means nothing is drawn (spaces, missing glyphs)
+	SDL_Rect source = { 0, 0, 0, 0 };
+
+	//The horizontal distance to the start of the next glyph
+	int advance = 0;
+};
+
+//A single line of text produced by GlyphAtlas::wrapText. Describes a range of the text that was wrapped.
+struct TextLine {
+	//The index of the first character of this line
+	int start = 0;
+
+	//The number of characters in this line, including trailing spaces but NOT the line break
+	int length = 0;
+
+	//The width of this line in pixels, not including trailing spaces
+	int width = 0;
+};
+
+class GlyphAtlas {
+public:
+	/**
+	 * GlyphAtlas constructor. Rasterizes every glyph in GLYPH_ATLAS_FIRST_CHAR to GLYPH_ATLAS_LAST_CHAR at the font's
+	 * size, packs them into a single surface, and uploads that surface as one texture.
+	 *
+	 * \param renderer: The SDL_Renderer* the atlas texture is created for
+	 * \param font: The TTF_Font* being used, already opened at the size all glyphs in this atlas are rasterized at
+	 */
+	GlyphAtlas(SDL_Renderer* renderer, TTF_Font* font);
+
+	/**
+	 * GlyphAtlas deconstructor. Destroys the atlas texture.
+	 */
+	~GlyphAtlas();
+
+	/**
+	 * \return The vertical distance between two lines of text at this atlas' font size.
+	 */
+	int getLineHeight() { return line_height; }
+
+	/**
+	 * \param c: A character of text
+	 * \return The horizontal distance the pen moves after drawing c.
+	 */
+	int getAdvance(unsigned char c) { return glyphs[c].advance; }
+
+	/**
+	 * Measure the width of a string of text, without drawing it.
+	 *
+	 * \param text: The text to be measured
+	 * \param length: The number of characters of text to measure
+	 * \return The width of the text in pixels
+	 */
+	int measureText(const char* text, int length);
+
+	/**
+	 * Break text into lines no wider than container_width. Lines are broken at line breaks ('\n'), and after the last
+	 * space that fits on the line. Words wider than the container are broken wherever they overflow.
+	 * There is always at least one line, even if text is empty.
+	 *
+	 * \param text: The text to be wrapped
+	 * \param length: The number of characters of text to wrap
+	 * \param container_width: The maximum width of a line. If 0 or less, lines only break at '\n'
+	 * \param lines: The vector the lines are written to. Its previous contents are cleared
+	 */
+	void wrapText(const char* text, int length, int container_width, std::vector<TextLine>& lines);
+
+	/**
+	 * Add a string of text to the current batch of quads. Nothing is displayed until flush() is called.
+	 *
+	 * \param text: The text to be drawn
+	 * \param length: The number of characters of text to draw
+	 * \param color: The color of the text
+	 * \param x: The x coordinate for the top-left corner of the text
+	 * \param y: The y coordinate for the top-left corner of the text
+	 */
+	void queueText(const char* text, int length, const SDL_Color* color, int x, int y);
+
+	/**
+	 * Draw every quad queued by queueText() with a single SDL_RenderGeometry call, then empty the batch.
+	 *
+	 * \param renderer: The SDL_Renderer* being used
+	 */
+	void flush(SDL_Renderer* renderer);
+
+private:
+	/**
+	 * A helper function to wrapText(). Add the line from start to end to lines, measuring it without trailing spaces.
+	 */
+	void pushLine(const char* text, int start, int end, std::vector<TextLine>& lines);
+
+	//The texture that every glyph is packed into
+	SDL_Texture* texture = nullptr;
+
+	//The width and height of the atlas texture, used to convert glyph positions into texture coordinates
+	int texture_w = 0;
+	int texture_h = 0;
+
+	//The vertical distance between two lines of text
+	int line_height = 0;
+
+	//The glyph for each character. Characters outside of the rasterized range are left empty
+	Glyph glyphs[256];
+
+	//The quads waiting to be drawn by flush()
+	std::vector<SDL_Vertex> vertices;
+
+	//The indices describing two triangles for each quad in 'vertices'
+	std::vector<int> indices;
+
+};
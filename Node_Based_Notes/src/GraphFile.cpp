@@ -0,0 +1,252 @@
+//Author: Connor Kamrowski. See header file for more information.
+#include "GraphFile.h"
+
+#include <cmath>
+
+/*
+ * The layout of version 1. Each value is the byte offset of a field, within the header or a record.
+ */
+
+//The header: the magic, then the version, the header's size and its flags
+const size_t HEADER_VERSION = 4;
+const size_t HEADER_SIZE = 8;
+const size_t HEADER_FLAGS = 12;
+
+//The number of nodes and the size of each node record, then the same for connections
+const size_t HEADER_NODE_COUNT = 16;
+const size_t HEADER_NODE_SIZE = 20;
+const size_t HEADER_CONNECTION_COUNT = 24;
+const size_t HEADER_CONNECTION_SIZE = 28;
+
+//Where the node records, connection records and string table start, and the size of the string table
+const size_t HEADER_NODES_START = 32;
+const size_t HEADER_CONNECTIONS_START = 40;
+const size_t HEADER_STRINGS_START = 48;
+const size_t HEADER_STRINGS_SIZE = 56;
+
+//The camera's x and y (as doubles), and zoom (as a float)
+const size_t HEADER_CAMERA_X = 64;
+const size_t HEADER_CAMERA_Y = 72;
+const size_t HEADER_CAMERA_ZOOM = 80;
+
+//The id of the GraphJournal that continues from this file. Files written before there was a journal have 0 here
+const size_t HEADER_JOURNAL_ID = 88;
+
+//The size of the header. The bytes after the last field are reserved, and written as 0
+const size_t HEADER_LENGTH = 96;
+
+//A node record: its title's start and length in the string table, its x and y, and its type
+const size_t NODE_TITLE_START = 0;
+const size_t NODE_TITLE_LENGTH = 4;
+const size_t NODE_X = 8;
+const size_t NODE_Y = 12;
+const size_t NODE_TYPE = 16;
+const size_t NODE_LENGTH = 24;
+
+//A connection record: the indices of its two nodes
+const size_t CONNECTION_A = 0;
+const size_t CONNECTION_B = 4;
+const size_t CONNECTION_LENGTH = 8;
+
+//The header flag set when the camera was saved
+const Uint32 FLAG_HAS_CAMERA = 1;
+
+//Append the title to the string table, and add a record pointing at it.
+void GraphFileData::addNode(std::string_view title, int x, int y, NodeType type) {
+	GraphFileNode node;
+	node.title_start = (Uint32)titles.length();
+	node.title_length = (Uint32)title.length();
+	node.x = x;
+	node.y = y;
+	node.type = type;
+
+	titles.append(title.data(), title.length());
+	nodes.push_back(node);
+}
+
+//Compare the first bytes to the magic.
+bool GraphFile::isBinary(const std::string& contents) {
+	return contents.length() >= sizeof(GRAPH_FILE_MAGIC) && std::memcmp(contents.data(), GRAPH_FILE_MAGIC, sizeof(GRAPH_FILE_MAGIC)) == 0;
+}
+
+/**
+ * Read the header, check that every section fits in the file, then copy the string table and read each record. The
+ * sizes of the header and records are read from the file, so records written by a newer version, with more fields at
+ * the end, are read by skipping the fields this version doesn't know.
+ */
+bool GraphFile::read(const std::string& contents, GraphFileData& out) {
+	out = GraphFileData();
+
+	if (!isBinary(contents) || contents.length() < HEADER_LENGTH) {
+		return false;
+	}
+
+	Uint32 version = readU32(contents, HEADER_VERSION);
+	Uint64 header_size = readU32(contents, HEADER_SIZE);
+	Uint32 flags = readU32(contents, HEADER_FLAGS);
+	Uint64 node_count = readU32(contents, HEADER_NODE_COUNT);
+	Uint64 node_size = readU32(contents, HEADER_NODE_SIZE);
+	Uint64 connection_count = readU32(contents, HEADER_CONNECTION_COUNT);
+	Uint64 connection_size = readU32(contents, HEADER_CONNECTION_SIZE);
+	Uint64 nodes_start = readU64(contents, HEADER_NODES_START);
+	Uint64 connections_start = readU64(contents, HEADER_CONNECTIONS_START);
+	Uint64 strings_start = readU64(contents, HEADER_STRINGS_START);
+	Uint64 strings_size = readU64(contents, HEADER_STRINGS_SIZE);
+	out.journal_id = readU64(contents, HEADER_JOURNAL_ID);
+
+	//Every field this version reads has to be there
+	if (version == 0 || header_size < HEADER_LENGTH || node_size < NODE_LENGTH || connection_size < CONNECTION_LENGTH) {
+		return false;
+	}
+
+	//Every section has to be inside of the file. The sizes are compared by dividing, so nothing can overflow
+	Uint64 length = contents.length();
+	if (nodes_start > length || node_count > (length - nodes_start) / node_size
+		|| connections_start > length || connection_count > (length - connections_start) / connection_size
+		|| strings_start > length || strings_size > length - strings_start) {
+		return false;
+	}
+
+	out.titles.assign(contents, (size_t)strings_start, (size_t)strings_size);
+
+	out.nodes.resize((size_t)node_count);
+	for (size_t i = 0; i < out.nodes.size(); i++) {
+		size_t record = (size_t)(nodes_start + i * node_size);
+		GraphFileNode& node = out.nodes[i];
+
+		node.title_start = readU32(contents, record + NODE_TITLE_START);
+		node.title_length = readU32(contents, record + NODE_TITLE_LENGTH);
+		node.x = (int)readU32(contents, record + NODE_X);
+		node.y = (int)readU32(contents, record + NODE_Y);
+
+		//A kind of node from a newer version is read as a note
+		Uint8 type = (Uint8)contents[record + NODE_TYPE];
+		node.type = (type < NODE_TYPE_COUNT) ? (NodeType)type : NODE_TYPE_NOTE;
+
+		if ((Uint64)node.title_start + node.title_length > strings_size) {
+			return false;
+		}
+	}
+
+	out.connections.resize((size_t)connection_count);
+	for (size_t i = 0; i < out.connections.size(); i++) {
+		size_t record = (size_t)(connections_start + i * connection_size);
+		out.connections[i].first = readU32(contents, record + CONNECTION_A);
+		out.connections[i].second = readU32(contents, record + CONNECTION_B);
+
+		if (out.connections[i].first >= node_count || out.connections[i].second >= node_count) {
+			return false;
+		}
+	}
+
+	//The floating point numbers are saved as their bits
+	if (flags & FLAG_HAS_CAMERA) {
+		Uint64 x_bits = readU64(contents, HEADER_CAMERA_X);
+		Uint64 y_bits = readU64(contents, HEADER_CAMERA_Y);
+		Uint32 zoom_bits = readU32(contents, HEADER_CAMERA_ZOOM);
+		std::memcpy(&out.camera.x, &x_bits, sizeof(x_bits));
+		std::memcpy(&out.camera.y, &y_bits, sizeof(y_bits));
+		std::memcpy(&out.camera.zoom, &zoom_bits, sizeof(zoom_bits));
+
+		out.has_camera = std::isfinite(out.camera.x) && std::isfinite(out.camera.y) && std::isfinite(out.camera.zoom);
+	}
+
+	return true;
+
+}//END OF read()
+
+/**
+ * Size the file once, then fill in the header and each record in place. The file is filled with zeros first, so the
+ * reserved bytes and padding are always 0.
+ */
+void GraphFile::write(const GraphFileData& data, std::string& out) {
+	size_t nodes_start = HEADER_LENGTH;
+	size_t connections_start = nodes_start + data.nodes.size() * NODE_LENGTH;
+	size_t strings_start = connections_start + data.connections.size() * CONNECTION_LENGTH;
+
+	out.assign(strings_start + data.titles.length(), '\0');
+
+	std::memcpy(&out[0], GRAPH_FILE_MAGIC, sizeof(GRAPH_FILE_MAGIC));
+	writeU32(out, HEADER_VERSION, GRAPH_FILE_VERSION);
+	writeU32(out, HEADER_SIZE, (Uint32)HEADER_LENGTH);
+	writeU32(out, HEADER_FLAGS, data.has_camera ? FLAG_HAS_CAMERA : 0);
+	writeU32(out, HEADER_NODE_COUNT, (Uint32)data.nodes.size());
+	writeU32(out, HEADER_NODE_SIZE, (Uint32)NODE_LENGTH);
+	writeU32(out, HEADER_CONNECTION_COUNT, (Uint32)data.connections.size());
+	writeU32(out, HEADER_CONNECTION_SIZE, (Uint32)CONNECTION_LENGTH);
+	writeU64(out, HEADER_NODES_START, nodes_start);
+	writeU64(out, HEADER_CONNECTIONS_START, connections_start);
+	writeU64(out, HEADER_STRINGS_START, strings_start);
+	writeU64(out, HEADER_STRINGS_SIZE, data.titles.length());
+	writeU64(out, HEADER_JOURNAL_ID, data.journal_id);
+
+	if (data.has_camera) {
+		Uint64 x_bits;
+		Uint64 y_bits;
+		Uint32 zoom_bits;
+		std::memcpy(&x_bits, &data.camera.x, sizeof(x_bits));
+		std::memcpy(&y_bits, &data.camera.y, sizeof(y_bits));
+		std::memcpy(&zoom_bits, &data.camera.zoom, sizeof(zoom_bits));
+		writeU64(out, HEADER_CAMERA_X, x_bits);
+		writeU64(out, HEADER_CAMERA_Y, y_bits);
+		writeU32(out, HEADER_CAMERA_ZOOM, zoom_bits);
+	}
+
+	for (size_t i = 0; i < data.nodes.size(); i++) {
+		size_t record = nodes_start + i * NODE_LENGTH;
+		const GraphFileNode& node = data.nodes[i];
+
+		writeU32(out, record + NODE_TITLE_START, node.title_start);
+		writeU32(out, record + NODE_TITLE_LENGTH, node.title_length);
+		writeU32(out, record + NODE_X, (Uint32)node.x);
+		writeU32(out, record + NODE_Y, (Uint32)node.y);
+		out[record + NODE_TYPE] = (char)node.type;
+	}
+
+	for (size_t i = 0; i < data.connections.size(); i++) {
+		size_t record = connections_start + i * CONNECTION_LENGTH;
+		writeU32(out, record + CONNECTION_A, data.connections[i].first);
+		writeU32(out, record + CONNECTION_B, data.connections[i].second);
+	}
+
+	if (!data.titles.empty()) {
+		std::memcpy(&out[strings_start], data.titles.data(), data.titles.length());
+	}
+
+}//END OF write()
+
+//Put the bytes back together, lowest first.
+Uint32 GraphFile::readU32(const std::string& contents, size_t offset) {
+	Uint32 value = 0;
+	for (int i = 3; i >= 0; i--) {
+		value = (value << 8) | (Uint8)contents[offset + i];
+	}
+	return value;
+}
+
+//Two 32 bit halves, the low half first.
+Uint64 GraphFile::readU64(const std::string& contents, size_t offset) {
+	return (Uint64)readU32(contents, offset) | ((Uint64)readU32(contents, offset + 4) << 32);
+}
+
+//Write the bytes, lowest first.
+void GraphFile::writeU32(std::string& out, size_t offset, Uint32 value) {
+	for (int i = 0; i < 4; i++) {
+		out[offset + i] = (char)((value >> (i * 8)) & 0xFF);
+	}
+}
+
+//Two 32 bit halves, the low half first.
+void GraphFile::writeU64(std::string& out, size_t offset, Uint64 value) {
+	writeU32(out, offset, (Uint32)value);
+	writeU32(out, offset + 4, (Uint32)(value >> 32));
+}
+
+//Mix in each byte: xor, then multiply by the FNV prime.
+Uint32 GraphFile::checksum(const char* begin, const char* end) {
+	Uint32 hash = 2166136261u;
+	for (const char* c = begin; c < end; c++) {
+		hash = (hash ^ (Uint8)*c) * 16777619u;
+	}
+	return hash;
+}
@@ -0,0 +1,125 @@
+/*
+ * GraphFile reads and writes the binary nbg file kept in each graph's directory, which saves everything about the
+ * graph that isn't in the notes themselves: where each node is, what kind of node it is, how the nodes are connected,
+ * and where the camera was looking.
+ *
+ * The file is laid out so it can be read straight from memory, without parsing any text:
+ *	* A header, starting with GRAPH_FILE_MAGIC, with the version, the counts, and where each section starts
+ *	* One fixed-size record for each node, with its position, type, and where its title is in the string table
+ *	* One fixed-size record for each connection, holding the indices of its two nodes
+ *	* The string table, holding every title one after another
+ *
+ * Every number is little-endian, and every section starts on a multiple of 8 bytes. The sizes of the header and
+ * records are saved in the header, and newer versions may only add fields to the end of them, so an older reader can
+ * still read the fields it knows about.
+ *
+ * Changes made after the file is saved are kept in the graph's GraphJournal, whose id is saved in the header.
+ *
+ * Older nbg files are text. They're still read by the GraphLoader, and are replaced by the binary format when
+ * the graph is opened.
+ *
+ * Author: Connor Kamrowski
+ */
+#pragma once
+#include "Config.h"
+#include "NodeStore.h"
+#include "Camera.h"
+
+#include <string_view>
+
+//A node saved in an nbg file
+struct GraphFileNode {
+	//Where the node's title starts in the string table, and its length
+	Uint32 title_start;
+	Uint32 title_length;
+
+	//The position of the center of the node
+	int x;
+	int y;
+
+	//The kind of node
+	NodeType type;
+};
+
+//Everything saved in an nbg file
+struct GraphFileData {
+	//The titles of every node, one after another
+	std::string titles;
+
+	//Every node
+	std::vector<GraphFileNode> nodes;
+
+	//Every connection, as the indices in 'nodes' of its two nodes
+	std::vector<std::pair<Uint32, Uint32>> connections;
+
+	//Indicates that the camera was saved
+	bool has_camera = false;
+
+	//Where the camera was looking when the graph was saved
+	CameraState camera;
+
+	//The id of the journal of changes made since this was saved. A journal with any other id is older than this
+	Uint64 journal_id = 0;
+
+	/**
+	 * Add a node, copying its title into the string table.
+	 *
+	 * \param title: The title of the node
+	 * \param x: The x position of the center of the node
+	 * \param y: The y position of the center of the node
+	 * \param type: The kind of node
+	 */
+	void addNode(std::string_view title, int x, int y, NodeType type);
+
+	/**
+	 * \return The title of a node. It points into 'titles', so it's only valid while 'titles' is unchanged.
+	 */
+	std::string_view getTitle(int index) const { return std::string_view(titles).substr(nodes[index].title_start, nodes[index].title_length); }
+};
+
+class GraphFile {
+public:
+	/**
+	 * \return true if the contents of an nbg file are in the binary format, rather than the older text format.
+	 */
+	static bool isBinary(const std::string& contents);
+
+	/**
+	 * Read the contents of a binary nbg file. Every section is checked against the size of the file before it's
+	 * read, so a damaged file is rejected instead of read past its end.
+	 *
+	 * \param contents: The whole file
+	 * \param out: The data read from the file. Its previous contents are replaced
+	 * \return false if the file isn't a binary nbg file, or is damaged
+	 */
+	static bool read(const std::string& contents, GraphFileData& out);
+
+	/**
+	 * Write the binary nbg file for a graph.
+	 *
+	 * \param data: Everything to save
+	 * \param out: The bytes of the file. Its previous contents are replaced
+	 */
+	static void write(const GraphFileData& data, std::string& out);
+
+	/**
+	 * Read a little-endian number from the file, at a byte offset already checked to be in the file. Also used for
+	 * the records of a GraphJournal.
+	 */
+	static Uint32 readU32(const std::string& contents, size_t offset);
+	static Uint64 readU64(const std::string& contents, size_t offset);
+
+	/**
+	 * Write a little-endian number into the file, at a byte offset already inside of it. Also used for the records of
+	 * a GraphJournal.
+	 */
+	static void writeU32(std::string& out, size_t offset, Uint32 value);
+	static void writeU64(std::string& out, size_t offset, Uint64 value);
+
+	/**
+	 * \return The checksum of the bytes between begin and end (32 bit FNV-1a). Used to find records that were only
+	 *	partly written when the program died.
+	 */
+	static Uint32 checksum(const char* begin, const char* end);
+
+};
@@ -0,0 +1,399 @@
+//Author: Connor Kamrowski. See header file for more information.
+#include "GraphJournal.h"
+
+#include <cmath>
+#include <filesystem>
+
+//The journal's header: the magic, the version, then the journal's id
+const size_t JOURNAL_VERSION_OFFSET = 4;
+const size_t JOURNAL_ID_OFFSET = 8;
+const size_t JOURNAL_HEADER_LENGTH = 16;
+
+//The start of each record: the length of its body, then the checksum of its body
+const size_t RECORD_BODY_LENGTH = 0;
+const size_t RECORD_CHECKSUM = 4;
+const size_t RECORD_HEADER_LENGTH = 8;
+
+/**
+ * The GraphJournal constructor. The thread is started last, once everything it uses is ready.
+ */
+GraphJournal::GraphJournal(const std::string& journal_path, const std::string& data_path)
+	: journal_path(journal_path), data_path(data_path) {
+	worker = std::thread(&GraphJournal::run, this);
+}
+
+/**
+ * The GraphJournal deconstructor. Tell the thread to stop, and wait for it to write everything still waiting.
+ */
+GraphJournal::~GraphJournal() {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	changed.notify_all();
+
+	worker.join();
+}
+
+//Keep where to continue from, then let the thread start writing.
+void GraphJournal::start(Uint64 journal_id, size_t length) {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		this->journal_id = journal_id;
+		start_length = length;
+		started = true;
+	}
+	changed.notify_all();
+}
+
+//The title, the position, then the type as one byte.
+void GraphJournal::addNode(const std::string& title, int x, int y, NodeType type) {
+	std::string body(1, (char)JOURNAL_ADD);
+	appendString(body, title);
+	appendU32(body, (Uint32)x);
+	appendU32(body, (Uint32)y);
+	body.push_back((char)type);
+	queueRecord(body);
+}
+
+//The title, then the position.
+void GraphJournal::moveNode(const std::string& title, int x, int y) {
+	std::string body(1, (char)JOURNAL_MOVE);
+	appendString(body, title);
+	appendU32(body, (Uint32)x);
+	appendU32(body, (Uint32)y);
+	queueRecord(body);
+}
+
+//The old title, then the new title.
+void GraphJournal::renameNode(const std::string& old_title, const std::string& new_title) {
+	std::string body(1, (char)JOURNAL_RENAME);
+	appendString(body, old_title);
+	appendString(body, new_title);
+	queueRecord(body);
+}
+
+//Just the title.
+void GraphJournal::deleteNode(const std::string& title) {
+	std::string body(1, (char)JOURNAL_DELETE);
+	appendString(body, title);
+	queueRecord(body);
+}
+
+//The titles of both nodes.
+void GraphJournal::connectNodes(const std::string& a, const std::string& b) {
+	std::string body(1, (char)JOURNAL_CONNECT);
+	appendString(body, a);
+	appendString(body, b);
+	queueRecord(body);
+}
+
+//The titles of both nodes.
+void GraphJournal::disconnectNodes(const std::string& a, const std::string& b) {
+	std::string body(1, (char)JOURNAL_DISCONNECT);
+	appendString(body, a);
+	appendString(body, b);
+	queueRecord(body);
+}
+
+//The bits of the x, y and zoom, each 64 bit number as two 32 bit halves with the low half first.
+void GraphJournal::saveCamera(const CameraState& camera) {
+	Uint64 x_bits;
+	Uint64 y_bits;
+	Uint32 zoom_bits;
+	std::memcpy(&x_bits, &camera.x, sizeof(x_bits));
+	std::memcpy(&y_bits, &camera.y, sizeof(y_bits));
+	std::memcpy(&zoom_bits, &camera.zoom, sizeof(zoom_bits));
+
+	std::string body(1, (char)JOURNAL_CAMERA);
+	appendU32(body, (Uint32)x_bits);
+	appendU32(body, (Uint32)(x_bits >> 32));
+	appendU32(body, (Uint32)y_bits);
+	appendU32(body, (Uint32)(y_bits >> 32));
+	appendU32(body, zoom_bits);
+	queueRecord(body);
+}
+
+/**
+ * Queue the snapshot, marking how many of the waiting records came before it. If a snapshot is already waiting, the
+ * new one replaces it, as it holds everything the old one did.
+ */
+void GraphJournal::compact(GraphFileData&& data) {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		snapshot = std::make_unique<GraphFileData>(std::move(data));
+		snapshot_split = pending.size();
+		compacting = true;
+	}
+	changed.notify_all();
+}
+
+//Count the records still waiting, as they'll be in the journal soon.
+bool GraphJournal::needsCompaction() {
+	std::lock_guard<std::mutex> guard(lock);
+	return !compacting && file_size + pending.size() > JOURNAL_COMPACT_SIZE;
+}
+
+/**
+ * Check the header, then read records until the end of the file, or until one is cut off or doesn't match its
+ * checksum. Anything after a bad record can't be trusted, as it may have been written over a partly written record.
+ */
+bool GraphJournal::read(const std::string& contents, Uint64 journal_id, std::vector<JournalEntry>& out, size_t* length) {
+	out.clear();
+	*length = 0;
+
+	if (contents.length() < JOURNAL_HEADER_LENGTH || std::memcmp(contents.data(), GRAPH_JOURNAL_MAGIC, sizeof(GRAPH_JOURNAL_MAGIC)) != 0) {
+		return false;
+	}
+	//A journal from a newer version may lay out its records differently, so it isn't replayed
+	Uint32 version = GraphFile::readU32(contents, JOURNAL_VERSION_OFFSET);
+	if (version == 0 || version > (Uint32)GRAPH_JOURNAL_VERSION || GraphFile::readU64(contents, JOURNAL_ID_OFFSET) != journal_id) {
+		return false;
+	}
+
+	size_t pos = JOURNAL_HEADER_LENGTH;
+	while (contents.length() - pos >= RECORD_HEADER_LENGTH) {
+		Uint32 body_length = GraphFile::readU32(contents, pos + RECORD_BODY_LENGTH);
+		Uint32 body_checksum = GraphFile::readU32(contents, pos + RECORD_CHECKSUM);
+
+		size_t body = pos + RECORD_HEADER_LENGTH;
+		if (body_length == 0 || body_length > contents.length() - body) {
+			break;
+		}
+
+		size_t end = body + body_length;
+		if (GraphFile::checksum(contents.data() + body, contents.data() + end) != body_checksum) {
+			break;
+		}
+
+		//Read the fields of the change. A kind of change from a newer version is skipped
+		JournalEntry entry;
+		entry.op = (JournalOp)(Uint8)contents[body];
+		size_t field = body + 1;
+		Uint32 x = 0;
+		Uint32 y = 0;
+		bool valid = true;
+
+		switch (entry.op) {
+		case JOURNAL_ADD:
+			valid = readString(contents, field, end, &entry.title) && readU32(contents, field, end, &x) && readU32(contents, field, end, &y) && field < end;
+			if (valid) {
+				Uint8 type = (Uint8)contents[field];
+				entry.type = (type < NODE_TYPE_COUNT) ? (NodeType)type : NODE_TYPE_NOTE;
+			}
+			break;
+		case JOURNAL_MOVE:
+			valid = readString(contents, field, end, &entry.title) && readU32(contents, field, end, &x) && readU32(contents, field, end, &y);
+			break;
+		case JOURNAL_RENAME:
+		case JOURNAL_CONNECT:
+		case JOURNAL_DISCONNECT:
+			valid = readString(contents, field, end, &entry.title) && readString(contents, field, end, &entry.other);
+			break;
+		case JOURNAL_DELETE:
+			valid = readString(contents, field, end, &entry.title);
+			break;
+		case JOURNAL_CAMERA: {
+			Uint32 bits[5];
+			for (int i = 0; i < 5 && valid; i++) {
+				valid = readU32(contents, field, end, &bits[i]);
+			}
+			if (valid) {
+				Uint64 x_bits = (Uint64)bits[0] | ((Uint64)bits[1] << 32);
+				Uint64 y_bits = (Uint64)bits[2] | ((Uint64)bits[3] << 32);
+				std::memcpy(&entry.camera.x, &x_bits, sizeof(x_bits));
+				std::memcpy(&entry.camera.y, &y_bits, sizeof(y_bits));
+				std::memcpy(&entry.camera.zoom, &bits[4], sizeof(bits[4]));
+				valid = std::isfinite(entry.camera.x) && std::isfinite(entry.camera.y) && std::isfinite(entry.camera.zoom);
+			}
+			break;
+		}
+		default:
+			valid = false;
+			break;
+		}
+
+		entry.x = (int)x;
+		entry.y = (int)y;
+		if (valid) {
+			out.push_back(entry);
+		}
+
+		pos = end;
+	}
+
+	*length = pos;
+	return true;
+
+}//END OF read()
+
+//Put the length and checksum in front of the body, then add it to the end of 'pending'.
+void GraphJournal::queueRecord(const std::string& body) {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+
+		size_t record = pending.size();
+		pending.resize(record + RECORD_HEADER_LENGTH);
+		GraphFile::writeU32(pending, record + RECORD_BODY_LENGTH, (Uint32)body.length());
+		GraphFile::writeU32(pending, record + RECORD_CHECKSUM, GraphFile::checksum(body.data(), body.data() + body.length()));
+		pending += body;
+	}
+	changed.notify_all();
+}
+
+/**
+ * Write until stopped. Everything waiting is taken at once, so a burst of changes is written and synced together.
+ * The records added before a snapshot go into the old journal first, so they're kept even if the snapshot fails.
+ */
+void GraphJournal::run() {
+	std::unique_lock<std::mutex> guard(lock);
+
+	changed.wait(guard, [&] { return started || stopping; });
+
+	//A graph closed before it finished loading has no journal to write to
+	if (!started) {
+		if (!pending.empty()) {
+			std::cout << "ERROR: The graph was closed before it was loaded. Its latest changes were not saved." << std::endl;
+		}
+		return;
+	}
+
+	guard.unlock();
+	open();
+	guard.lock();
+
+	while (true) {
+		changed.wait(guard, [&] { return !pending.empty() || snapshot != nullptr || stopping; });
+
+		//Only stop once everything has been written
+		if (pending.empty() && snapshot == nullptr) {
+			return;
+		}
+
+		//take everything waiting
+		std::unique_ptr<GraphFileData> next_snapshot = std::move(snapshot);
+		size_t split = (next_snapshot != nullptr) ? snapshot_split : pending.size();
+		std::string before = pending.substr(0, split);
+		std::string after = pending.substr(split);
+		pending.clear();
+
+		//write without holding the lock
+		guard.unlock();
+		bool reset = false;
+
+		if (!before.empty() && !FileIO::appendFile(journal_path, before)) {
+			std::cout << "ERROR: The graph's changes could not be saved. Path: " << journal_path << std::endl;
+		}
+		if (next_snapshot != nullptr) {
+			reset = writeSnapshot(*next_snapshot);
+		}
+		if (!after.empty() && !FileIO::appendFile(journal_path, after)) {
+			std::cout << "ERROR: The graph's changes could not be saved. Path: " << journal_path << std::endl;
+		}
+		guard.lock();
+
+		//After a snapshot, the journal holds only the header and the records added after it
+		if (reset) {
+			file_size = JOURNAL_HEADER_LENGTH;
+		}
+		else {
+			file_size += before.length();
+		}
+		file_size += after.length();
+
+		if (next_snapshot != nullptr) {
+			compacting = (snapshot != nullptr);
+		}
+	}
+
+}//END OF run()
+
+/**
+ * Cut off anything after the last record replayed, which is a record cut off when the program died. New records have
+ * to follow a whole record, or they could never be read. A journal that couldn't be replayed is replaced.
+ */
+void GraphJournal::open() {
+	std::error_code error;
+	if (start_length >= JOURNAL_HEADER_LENGTH) {
+		std::filesystem::resize_file(journal_path, start_length, error);
+	}
+
+	size_t size = start_length;
+	if (start_length < JOURNAL_HEADER_LENGTH || error) {
+		size = JOURNAL_HEADER_LENGTH;
+		if (!resetJournal(journal_id)) {
+			std::cout << "ERROR: The graph's journal could not be created. Path: " << journal_path << std::endl;
+		}
+	}
+
+	std::lock_guard<std::mutex> guard(lock);
+	file_size = size;
+}
+
+/**
+ * Save the snapshot with the next journal id before starting that journal. If the program dies between the two, the
+ * old journal is left with the old id, and it's skipped when the graph is opened, since the snapshot already has it.
+ */
+bool GraphJournal::writeSnapshot(GraphFileData& data) {
+	data.journal_id = journal_id + 1;
+
+	std::string bytes;
+	GraphFile::write(data, bytes);
+	if (!FileIO::writeFileAtomic(data_path, StringSnapshot(std::move(bytes)), true)) {
+		std::cout << "ERROR: The Node metadata could not be saved. Path: " << data_path << std::endl;
+		return false;
+	}
+
+	journal_id++;
+	if (!resetJournal(journal_id)) {
+		std::cout << "ERROR: The graph's journal could not be created. Path: " << journal_path << std::endl;
+	}
+
+	return true;
+}
+
+//Write the header alone, replacing the whole journal in one step.
+bool GraphJournal::resetJournal(Uint64 id) {
+	std::string header(JOURNAL_HEADER_LENGTH, '\0');
+	std::memcpy(&header[0], GRAPH_JOURNAL_MAGIC, sizeof(GRAPH_JOURNAL_MAGIC));
+	GraphFile::writeU32(header, JOURNAL_VERSION_OFFSET, GRAPH_JOURNAL_VERSION);
+	GraphFile::writeU64(header, JOURNAL_ID_OFFSET, id);
+
+	return FileIO::writeFileAtomic(journal_path, StringSnapshot(std::move(header)), true);
+}
+
+//Grow the body by 4 bytes, and write the number into them.
+void GraphJournal::appendU32(std::string& body, Uint32 value) {
+	size_t offset = body.size();
+	body.resize(offset + 4);
+	GraphFile::writeU32(body, offset, value);
+}
+
+//The length of the text, then the text.
+void GraphJournal::appendString(std::string& body, const std::string& text) {
+	appendU32(body, (Uint32)text.length());
+	body += text;
+}
+
+//Check the number fits before the end of the body, then read it.
+bool GraphJournal::readU32(const std::string& contents, size_t& pos, size_t end, Uint32* out) {
+	if (end - pos < 4) {
+		return false;
+	}
+
+	*out = GraphFile::readU32(contents, pos);
+	pos += 4;
+	return true;
+}
+
+//Read the length, then point at the text after it, if it all fits before the end of the body.
+bool GraphJournal::readString(const std::string& contents, size_t& pos, size_t end, std::string_view* out) {
+	Uint32 length;
+	if (!readU32(contents, pos, end, &length) || length > end - pos) {
+		return false;
+	}
+
+	*out = std::string_view(contents).substr(pos, length);
+	pos += length;
+	return true;
+}
@@ -0,0 +1,244 @@
+/*
+ * GraphJournal saves each change to a graph's metadata the moment it's made, so nothing is lost if the program is
+ * killed, and saving never costs more than the change itself. Moving, adding, renaming, deleting and connecting nodes
+ * each add one small record to the end of the journal file, which is written and synced on a background thread.
+ *
+ * The nbg file is a snapshot of the graph, and the journal holds every change made since. When the graph is opened,
+ * the GraphLoader reads the snapshot and then replays the journal on top of it. Once the journal grows past
+ * JOURNAL_COMPACT_SIZE, GraphManager hands over a new snapshot, which is written in the background before the journal
+ * is started over.
+ *
+ * The journal file is a header, starting with GRAPH_JOURNAL_MAGIC, followed by the records:
+ *	* The header holds the version and the journal's id. The nbg file saves the id of the journal that continues
+ *	  from it, so a journal left over from before the last snapshot is never replayed twice
+ *	* Each record is its length, a checksum, then the kind of change and its fields. A record cut off when the
+ *	  program died fails its checksum, and the journal is read up to the record before it
+ *
+ * Author: Connor Kamrowski
+ */
+#pragma once
+#include "Config.h"
+#include "GraphFile.h"
+#include "FileIO.h"
+
+#include <mutex>
+#include <condition_variable>
+
+//The kinds of change saved in a journal
+enum JournalOp {
+	JOURNAL_ADD = 1,
+	JOURNAL_MOVE,
+	JOURNAL_RENAME,
+	JOURNAL_DELETE,
+	JOURNAL_CONNECT,
+	JOURNAL_DISCONNECT,
+	JOURNAL_CAMERA
+};
+
+//A change read from a journal. The titles point into the journal's contents
+struct JournalEntry {
+	//The kind of change
+	JournalOp op;
+
+	//The node changed. For a connection, one of its two nodes
+	std::string_view title;
+
+	//The new title of a renamed node, or the other node of a connection
+	std::string_view other;
+
+	//The position of the center of an added or moved node
+	int x = 0;
+	int y = 0;
+
+	//The kind of an added node
+	NodeType type = NODE_TYPE_NOTE;
+
+	//The camera, when it was saved
+	CameraState camera;
+};
+
+class GraphJournal {
+public:
+	/**
+	 * GraphJournal constructor. Starts the writing thread. Changes can be added right away, but nothing is written
+	 * until start() is called, as the GraphLoader may still be reading the journal.
+	 *
+	 * \param journal_path: The path of the graph's journal file
+	 * \param data_path: The path of the graph's nbg file, which snapshots are written to
+	 */
+	GraphJournal(const std::string& journal_path, const std::string& data_path);
+
+	/**
+	 * GraphJournal deconstructor. Writes every change and snapshot still waiting, then stops the writing thread.
+	 */
+	~GraphJournal();
+
+	/**
+	 * Start writing, continuing from the journal the GraphLoader replayed.
+	 *
+	 * \param journal_id: The id of the journal that continues from the nbg file
+	 * \param length: The number of bytes of the journal file that were replayed. Anything after them is cut off. If
+	 *	0, the journal couldn't be replayed, and a new, empty one is started
+	 */
+	void start(Uint64 journal_id, size_t length);
+
+	/**
+	 * Save that a node was added.
+	 *
+	 * \param title: The title of the node
+	 * \param x: The x position of the center of the node
+	 * \param y: The y position of the center of the node
+	 * \param type: The kind of node
+	 */
+	void addNode(const std::string& title, int x, int y, NodeType type);
+
+	/**
+	 * Save that a node was moved.
+	 *
+	 * \param title: The title of the node
+	 * \param x: The new x position of the center of the node
+	 * \param y: The new y position of the center of the node
+	 */
+	void moveNode(const std::string& title, int x, int y);
+
+	/**
+	 * Save that a node was renamed.
+	 *
+	 * \param old_title: The title the node had before
+	 * \param new_title: The title the node has now
+	 */
+	void renameNode(const std::string& old_title, const std::string& new_title);
+
+	/**
+	 * Save that a node was deleted, along with its connections.
+	 *
+	 * \param title: The title of the node
+	 */
+	void deleteNode(const std::string& title);
+
+	/**
+	 * Save that two nodes were connected.
+	 */
+	void connectNodes(const std::string& a, const std::string& b);
+
+	/**
+	 * Save that two nodes were disconnected.
+	 */
+	void disconnectNodes(const std::string& a, const std::string& b);
+
+	/**
+	 * Save where the camera is looking.
+	 */
+	void saveCamera(const CameraState& camera);
+
+	/**
+	 * Write a snapshot of the whole graph to the nbg file in the background, then start the journal over. Every change
+	 * added before this is in the snapshot, and every change added after goes into the new journal.
+	 *
+	 * \param data: Everything about the graph, as it is right now
+	 */
+	void compact(GraphFileData&& data);
+
+	/**
+	 * \return true if the journal has grown past JOURNAL_COMPACT_SIZE, and isn't being compacted already.
+	 */
+	bool needsCompaction();
+
+	/**
+	 * Read the changes saved in a journal file.
+	 *
+	 * \param contents: The whole journal file
+	 * \param journal_id: The id saved in the nbg file. A journal with any other id was already compacted into it
+	 * \param out: The changes read, in the order they were made. Its previous contents are replaced
+	 * \param length: Set to the number of bytes read, up to the end of the last whole record
+	 * \return false if the file isn't a journal, isn't the journal with that id, or was written by a newer version
+	 */
+	static bool read(const std::string& contents, Uint64 journal_id, std::vector<JournalEntry>& out, size_t* length);
+
+private:
+	/**
+	 * Add a record to the changes waiting to be written, and wake the writing thread.
+	 *
+	 * \param body: The kind of change, followed by its fields
+	 */
+	void queueRecord(const std::string& body);
+
+	/**
+	 * The writing thread. Writes the waiting records and snapshots, in order, until the journal is stopped.
+	 */
+	void run();
+
+	/**
+	 * Trim the journal to the length replayed, or start a new one. Only called by the writing thread.
+	 */
+	void open();
+
+	/**
+	 * Write a snapshot to the nbg file, then start the journal over with the next id. Only called by the writing
+	 * thread.
+	 *
+	 * \return false if the snapshot couldn't be written, in which case the journal is kept
+	 */
+	bool writeSnapshot(GraphFileData& data);
+
+	/**
+	 * Replace the journal file with an empty journal. Only called by the writing thread.
+	 *
+	 * \param id: The id of the new journal
+	 * \return false if the journal couldn't be written
+	 */
+	bool resetJournal(Uint64 id);
+
+	/**
+	 * Add a field to the body of a record.
+	 */
+	static void appendU32(std::string& body, Uint32 value);
+	static void appendString(std::string& body, const std::string& text);
+
+	/**
+	 * Read a field from the body of a record, moving pos past it.
+	 *
+	 * \return false if the field goes past end
+	 */
+	static bool readU32(const std::string& contents, size_t& pos, size_t end, Uint32* out);
+	static bool readString(const std::string& contents, size_t& pos, size_t end, std::string_view* out);
+
+	//The path of the journal file, and of the nbg file
+	std::string journal_path;
+	std::string data_path;
+
+	//The records waiting to be written
+	std::string pending;
+
+	//The snapshot waiting to be written. Null if there isn't one
+	std::unique_ptr<GraphFileData> snapshot;
+
+	//The number of bytes of 'pending' added before the snapshot. They go in the old journal, the rest in the new one
+	size_t snapshot_split = 0;
+
+	//Indicates that a snapshot is waiting or being written
+	bool compacting = false;
+
+	//The size of the journal file, as of the last write
+	size_t file_size = 0;
+
+	//The id of the journal, and the length replayed, given to start()
+	Uint64 journal_id = 0;
+	size_t start_length = 0;
+
+	//Indicates that start() was called, so records can be written
+	bool started = false;
+
+	//Indicates that the thread should stop once everything waiting is written
+	bool stopping = false;
+
+	//Guards everything above that's shared with the writing thread
+	std::mutex lock;
+
+	//Wakes the thread when a record or snapshot is added
+	std::condition_variable changed;
+
+	//The thread that does the writing
+	std::thread worker;
+
+};
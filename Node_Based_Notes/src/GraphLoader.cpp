@@ -0,0 +1,481 @@
+//Author: Connor Kamrowski. See header file for more information.
+#include "GraphLoader.h"
+
+#include <charconv>
+#include <iterator>
+#include <set>
+
+/**
+ * The GraphLoader constructor. The first two tasks are queued before the threads start, so there's always work for at
+ * least two of them: listing the notes, and reading the nbg file.
+ */
+GraphLoader::GraphLoader(const std::string& graph_path, const std::string& data_path, const std::string& journal_path,
+	NoteStorage* storage) : graph_path(graph_path), data_path(data_path), journal_path(journal_path), storage(storage) {
+
+	queueTask([this] { scanDirectory(); });
+	queueTask([this] { readMetadata(); });
+
+	//hardware_concurrency() may not know, in which case it returns 0
+	int thread_count = std::max(2, std::min((int)std::thread::hardware_concurrency(), LOADER_MAX_THREADS));
+	for (int i = 0; i < thread_count; i++) {
+		workers.push_back(std::thread(&GraphLoader::run, this));
+	}
+}
+
+/**
+ * The GraphLoader deconstructor. Tasks not yet started are dropped, and the deconstructor waits for the running ones.
+ */
+GraphLoader::~GraphLoader() {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	changed.notify_all();
+
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+//Swap the waiting nodes out, so the vectors trade memory instead of copying.
+bool GraphLoader::takeBatch(std::vector<LoadedNode>& out) {
+	out.clear();
+
+	std::lock_guard<std::mutex> guard(lock);
+	out.swap(ready);
+
+	return !out.empty();
+}
+
+//Sleep until the last task finishes.
+void GraphLoader::wait() {
+	std::unique_lock<std::mutex> guard(lock);
+	changed.wait(guard, [&] { return tasks_left == 0 || stopping; });
+}
+
+//Finished once there's nothing left to run, and nothing left to take.
+bool GraphLoader::isFinished() {
+	std::lock_guard<std::mutex> guard(lock);
+	return tasks_left == 0 && ready.empty();
+}
+
+//Give the camera once it's been read, and only once.
+bool GraphLoader::takeCamera(CameraState* out) {
+	std::lock_guard<std::mutex> guard(lock);
+	if (!metadata_ready || !has_camera) {
+		return false;
+	}
+
+	*out = camera;
+	has_camera = false;
+	return true;
+}
+
+//Copy the counts while holding the lock.
+void GraphLoader::getProgress(int* found, bool* scanned) {
+	std::lock_guard<std::mutex> guard(lock);
+	*found = this->found;
+	*scanned = this->scanned;
+}
+
+//Count the task, then wake a worker for it.
+void GraphLoader::queueTask(std::function<void()> task) {
+	tasks.push_back(std::move(task));
+	tasks_left++;
+	changed.notify_one();
+}
+
+/**
+ * Run tasks until stopped, or until there are none left. The lock is only held while taking a task, never while
+ * running one, so the UI thread can take nodes while the workers keep reading.
+ */
+void GraphLoader::run() {
+	std::unique_lock<std::mutex> guard(lock);
+
+	while (true) {
+		changed.wait(guard, [&] { return !tasks.empty() || tasks_left == 0 || stopping; });
+
+		//A task can only be queued by another task, so once none are left, the graph has been read
+		if (tasks.empty() || stopping) {
+			return;
+		}
+
+		std::function<void()> task = std::move(tasks.front());
+		tasks.pop_front();
+
+		//run the task without holding the lock
+		guard.unlock();
+		task();
+		guard.lock();
+
+		tasks_left--;
+		if (tasks_left == 0) {
+			//wake wait(), and every worker so they can return
+			changed.notify_all();
+		}
+	}
+
+}//END OF run()
+
+/**
+ * List the notes. Only the worker running this lists them, as listing can't be split up, but the names are handed off
+ * in batches, so the other workers turn them into nodes while the listing continues.
+ */
+void GraphLoader::scanDirectory() {
+	std::vector<std::string> names;
+	bool stopped = false;
+
+	storage->list([&](std::string&& title) {
+		names.push_back(std::move(title));
+
+		if ((int)names.size() == LOAD_BATCH_SIZE) {
+			//stop listing if the loader is being destroyed
+			if (!queueNames(std::move(names))) {
+				stopped = true;
+				return false;
+			}
+			names.clear();
+		}
+
+		return true;
+	});
+
+	if (stopped) {
+		return;
+	}
+
+	queueNames(std::move(names));
+
+	std::lock_guard<std::mutex> guard(lock);
+	scanned = true;
+
+}//END OF scanDirectory()
+
+//Turn the names into nodes now if the positions are known, otherwise keep them until they are.
+bool GraphLoader::queueNames(std::vector<std::string>&& names) {
+	std::lock_guard<std::mutex> guard(lock);
+	if (stopping) {
+		return false;
+	}
+	if (names.empty()) {
+		return true;
+	}
+
+	found += (int)names.size();
+
+	if (metadata_ready) {
+		queueTask([this, names = std::move(names)]() mutable { buildBatch(names); });
+	}
+	else {
+		waiting_names.push_back(std::move(names));
+	}
+
+	return true;
+}
+
+/**
+ * Read the whole nbg file at once, which is much faster than a line at a time on a slow disk. In an older, text file,
+ * the node lines come first, until an empty line, and are split into chunks of about LOAD_CHUNK_SIZE bytes for the
+ * workers to parse. The connection lines after them are read here, while the chunks are being parsed. The journal is
+ * read here too, and replayed once the nbg file has been.
+ */
+void GraphLoader::readMetadata() {
+	//A missing journal is the same as an empty one
+	FileIO::readFile(journal_path, journal, true);
+
+	std::string contents;
+
+	if (!FileIO::readFile(data_path, contents, true)) {
+		std::cout << "Couldn't open graph data. Using default positions." << std::endl;
+		finishMetadata();
+		return;
+	}
+
+	if (GraphFile::isBinary(contents)) {
+		readBinaryMetadata(contents);
+		return;
+	}
+
+	//The titles point into the contents, so they're moved to where they're kept first
+	FileIO::normalizeLineEndings(contents);
+	metadata = std::move(contents);
+
+	//The node lines end at the first empty line
+	size_t nodes_length = (!metadata.empty() && metadata[0] == '\n') ? 0 : metadata.find("\n\n");
+	if (nodes_length == std::string::npos) {
+		nodes_length = metadata.size();
+	}
+
+	//The rest of the lines are connections
+	std::string_view text(metadata);
+	size_t line_start = std::min(nodes_length + 2, text.size());
+	while (line_start < text.size()) {
+		size_t line_end = text.find('\n', line_start);
+		if (line_end == std::string_view::npos) {
+			line_end = text.size();
+		}
+
+		std::string_view line = text.substr(line_start, line_end - line_start);
+		size_t separator = line.find(CONNECTION_SEPARATOR);
+		if (separator != std::string_view::npos) {
+			connection_data.push_back({ line.substr(0, separator), line.substr(separator + CONNECTION_SEPARATOR.length()) });
+		}
+
+		line_start = line_end + 1;
+	}
+
+	//Split the node lines into chunks, each ending at the end of a line
+	std::vector<std::pair<const char*, const char*>> chunks;
+	const char* begin = metadata.data();
+	const char* nodes_end = metadata.data() + nodes_length;
+	while (begin < nodes_end) {
+		const char* end = std::find(begin + std::min<size_t>(LOAD_CHUNK_SIZE, nodes_end - begin - 1), nodes_end, '\n');
+		chunks.push_back({ begin, end });
+		begin = end + 1;
+	}
+
+	if (chunks.empty()) {
+		finishMetadata();
+		return;
+	}
+
+	std::lock_guard<std::mutex> guard(lock);
+	parsed_chunks.resize(chunks.size());
+	chunks_left = (int)chunks.size();
+	for (int i = 0; i < (int)chunks.size(); i++) {
+		queueTask([this, i, chunk = chunks[i]] { parseChunk(i, chunk.first, chunk.second); });
+	}
+
+}//END OF readMetadata()
+
+/**
+ * Read every node and connection from the file's records. There's nothing to parse, so this is done in one task. A
+ * damaged file is treated like a missing one, and every node starts at the default position.
+ */
+void GraphLoader::readBinaryMetadata(const std::string& contents) {
+	if (!GraphFile::read(contents, saved)) {
+		std::cout << "ERROR: The graph data is damaged. Using default positions." << std::endl;
+		saved = GraphFileData();
+	}
+	else {
+		snapshot_current = true;
+	}
+
+	//A title saved twice keeps its last position
+	positions.reserve(saved.nodes.size());
+	for (int i = 0; i < (int)saved.nodes.size(); i++) {
+		const GraphFileNode& node = saved.nodes[i];
+		positions[saved.getTitle(i)] = { node.x, node.y, node.type };
+	}
+
+	connection_data.reserve(saved.connections.size());
+	for (const auto& connection : saved.connections) {
+		connection_data.push_back({ saved.getTitle(connection.first), saved.getTitle(connection.second) });
+	}
+
+	has_camera = saved.has_camera;
+	camera = saved.camera;
+	journal_id = saved.journal_id;
+
+	finishMetadata();
+}
+
+/**
+ * Parse each line of the chunk. A line is the title, " at ", then the x,y position. The title is everything before
+ * the last " at ", so a title containing it still works. A line that can't be read is skipped.
+ */
+void GraphLoader::parseChunk(int chunk, const char* begin, const char* end) {
+	std::vector<std::pair<std::string_view, SavedNode>> parsed;
+
+	while (begin < end) {
+		const char* line_end = std::find(begin, end, '\n');
+		std::string_view line(begin, line_end - begin);
+		begin = line_end + 1;
+
+		size_t at = line.rfind(" at ");
+		if (at == std::string_view::npos) {
+			continue;
+		}
+
+		//Read the numbers in place, without copying them into strings first
+		const char* numbers = line.data() + at + 4;
+		const char* numbers_end = line.data() + line.size();
+		SavedNode node;
+		node.type = NODE_TYPE_NOTE;
+
+		std::from_chars_result x = std::from_chars(numbers, numbers_end, node.x);
+		if (x.ec != std::errc() || x.ptr == numbers_end || *x.ptr != ',') {
+			continue;
+		}
+		if (std::from_chars(x.ptr + 1, numbers_end, node.y).ec != std::errc()) {
+			continue;
+		}
+
+		//Text files saved the top-left corner of each node, not its center
+		node.x += NODE_WIDTH / 2;
+		node.y += NODE_WIDTH / 2;
+
+		parsed.push_back({ line.substr(0, at), node });
+	}
+
+	bool last;
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		parsed_chunks[chunk] = std::move(parsed);
+		last = (--chunks_left == 0);
+	}
+
+	if (last) {
+		finishMetadata();
+	}
+
+}//END OF parseChunk()
+
+/**
+ * Merge the chunks in order, so a title written twice keeps its last position, then replay the journal over them. Only
+ * the task that finished the last chunk gets here, and no batch reads 'positions' until metadata_ready is set, so the
+ * merge doesn't need the lock.
+ */
+void GraphLoader::finishMetadata() {
+	size_t count = positions.size();
+	for (const auto& parsed : parsed_chunks) {
+		count += parsed.size();
+	}
+	positions.reserve(count);
+
+	for (const auto& parsed : parsed_chunks) {
+		for (const auto& node : parsed) {
+			positions[node.first] = node.second;
+		}
+	}
+
+	replayJournal();
+
+	std::lock_guard<std::mutex> guard(lock);
+	metadata_ready = true;
+
+	//The chunks aren't needed anymore. The file is kept, as the titles point into it
+	std::vector<std::vector<std::pair<std::string_view, SavedNode>>>().swap(parsed_chunks);
+
+	//Every batch found so far can be turned into nodes now
+	for (std::vector<std::string>& names : waiting_names) {
+		queueTask([this, names = std::move(names)]() mutable { buildBatch(names); });
+	}
+	waiting_names.clear();
+
+}//END OF finishMetadata()
+
+/**
+ * Apply each change in the order it was made. While replaying, the connections are kept in a set with the smaller
+ * title first, so a connection can be found from either end. Renaming or deleting a node checks every connection, but
+ * both are rare next to moves.
+ */
+void GraphLoader::replayJournal() {
+	std::vector<JournalEntry> entries;
+	if (!GraphJournal::read(journal, journal_id, entries, &journal_length)) {
+		//The journal is missing, damaged, or was already compacted into the nbg file
+		journal_length = 0;
+		return;
+	}
+
+	if (entries.empty()) {
+		return;
+	}
+
+	auto key = [](std::string_view a, std::string_view b) { return (a < b) ? std::make_pair(a, b) : std::make_pair(b, a); };
+
+	std::set<std::pair<std::string_view, std::string_view>> linked;
+	for (const auto& connection : connection_data) {
+		linked.insert(key(connection.first, connection.second));
+	}
+
+	//Remove every connection to a title. If the node was renamed, the connections are given to its new title
+	auto relink = [&](std::string_view title, bool renamed, std::string_view new_title) {
+		std::vector<std::string_view> others;
+		for (auto connection = linked.begin(); connection != linked.end();) {
+			if (connection->first == title || connection->second == title) {
+				others.push_back((connection->first == title) ? connection->second : connection->first);
+				connection = linked.erase(connection);
+			}
+			else {
+				connection++;
+			}
+		}
+
+		if (renamed) {
+			for (std::string_view other : others) {
+				linked.insert(key(new_title, other));
+			}
+		}
+	};
+
+	for (const JournalEntry& entry : entries) {
+		switch (entry.op) {
+		case JOURNAL_ADD:
+			positions[entry.title] = { entry.x, entry.y, entry.type };
+			break;
+		case JOURNAL_MOVE: {
+			//A moved node keeps its kind
+			auto found = positions.find(entry.title);
+			NodeType type = (found != positions.end()) ? found->second.type : NODE_TYPE_NOTE;
+			positions[entry.title] = { entry.x, entry.y, type };
+			break;
+		}
+		case JOURNAL_RENAME: {
+			auto found = positions.find(entry.title);
+			if (found != positions.end()) {
+				SavedNode node = found->second;
+				positions.erase(found);
+				positions[entry.other] = node;
+			}
+			relink(entry.title, true, entry.other);
+			break;
+		}
+		case JOURNAL_DELETE:
+			positions.erase(entry.title);
+			relink(entry.title, false, std::string_view());
+			break;
+		case JOURNAL_CONNECT:
+			linked.insert(key(entry.title, entry.other));
+			break;
+		case JOURNAL_DISCONNECT:
+			linked.erase(key(entry.title, entry.other));
+			break;
+		case JOURNAL_CAMERA:
+			has_camera = true;
+			camera = entry.camera;
+			break;
+		}
+	}
+
+	connection_data.assign(linked.begin(), linked.end());
+
+}//END OF replayJournal()
+
+//Look up the position of each name, then add the nodes to the ones waiting for the UI thread.
+void GraphLoader::buildBatch(std::vector<std::string>& names) {
+	std::vector<LoadedNode> batch;
+	batch.reserve(names.size());
+
+	for (std::string& name : names) {
+		LoadedNode node;
+		node.file_name = graph_path + name + ".txt";
+		node.x = DEFAULT_NODE_POS;
+		node.y = DEFAULT_NODE_POS;
+		node.type = NODE_TYPE_NOTE;
+
+		auto position = positions.find(name);
+		if (position != positions.end()) {
+			node.x = position->second.x;
+			node.y = position->second.y;
+			node.type = position->second.type;
+		}
+
+		node.title = std::move(name);
+		batch.push_back(std::move(node));
+	}
+
+	std::lock_guard<std::mutex> guard(lock);
+	ready.insert(ready.end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+
+}//END OF buildBatch()
@@ -0,0 +1,265 @@
+/*
+ * GraphLoader reads a graph's notes and nbg file on a pool of worker threads, so a large graph can be opened
+ * without freezing the window. The nodes are handed back in batches as they're read, and GraphManager adds each batch
+ * to the graph between frames, so the graph fills in while the user can already pan, zoom and open notes.
+ *
+ * Loading is split into tasks:
+ *	* One task lists the notes in the graph's NoteStorage, a batch of names at a time
+ *	* One task reads the nbg file. A binary file is read straight from its records. An older, text file has its node
+ *	  lines split into chunks that are parsed by the other workers
+ *	* Once the nbg file is read, the changes in the graph's journal are replayed on top of it. Then every position is
+ *	  known, and each batch of names is turned into nodes by whichever worker is free
+ *
+ * The titles read from the nbg file are never copied, they point into the file's contents, which are kept until the
+ * loader is deleted.
+ *
+ * Nothing in the graph itself is touched by the workers. Only the UI thread adds nodes, in takeBatch().
+ *
+ * Author: Connor Kamrowski
+ */
+#pragma once
+#include "Config.h"
+#include "GraphFile.h"
+#include "GraphJournal.h"
+#include "FileIO.h"
+#include "NoteStorage.h"
+
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <unordered_map>
+
+//A node read by the GraphLoader, ready to be added to the graph
+struct LoadedNode {
+	//The title of the node
+	std::string title;
+
+	//The local path to the node's file
+	std::string file_name;
+
+	//The position of the center of the node
+	int x;
+	int y;
+
+	//The kind of node
+	NodeType type;
+};
+
+class GraphLoader {
+public:
+	/**
+	 * GraphLoader constructor. Starts the worker threads, which start reading the graph right away.
+	 *
+	 * \param graph_path: The path of the graph's directory, ending in '/'
+	 * \param data_path: The path of the graph's nbg file
+	 * \param journal_path: The path of the graph's journal file
+	 * \param storage: The storage of the graph's notes, which is listed for the titles
+	 */
+	GraphLoader(const std::string& graph_path, const std::string& data_path, const std::string& journal_path,
+		NoteStorage* storage);
+
+	/**
+	 * GraphLoader deconstructor. Stops any loading still going, and waits for the workers to finish.
+	 */
+	~GraphLoader();
+
+	/**
+	 * Take every node read since the last call, without waiting.
+	 *
+	 * \param out: The vector the nodes are written to. Its previous contents are cleared
+	 * \return true if any nodes were taken
+	 */
+	bool takeBatch(std::vector<LoadedNode>& out);
+
+	/**
+	 * Wait until the workers have read everything. The nodes still have to be taken with takeBatch().
+	 */
+	void wait();
+
+	/**
+	 * \return true once everything was read, and every node has been taken.
+	 */
+	bool isFinished();
+
+	/**
+	 * The number of nodes found so far, for showing the progress of the load.
+	 *
+	 * \param found: Set to the number of notes found in the directory so far
+	 * \param scanned: Set to true once the whole directory has been listed, meaning 'found' is the total
+	 */
+	void getProgress(int* found, bool* scanned);
+
+	/**
+	 * Get where the camera was looking when the graph was saved. It's only given once, so the camera isn't moved
+	 * back there after the user moves it.
+	 *
+	 * \param out: Set to the saved camera
+	 * \return true if the camera was saved, and hasn't been taken already
+	 */
+	bool takeCamera(CameraState* out);
+
+	/**
+	 * \return The titles of each pair of connected nodes. Only complete once the loader is finished.
+	 */
+	const std::vector<std::pair<std::string_view, std::string_view>>& getConnections() const { return connection_data; }
+
+	/**
+	 * \return The id of the journal that continues from the nbg file. Only known once the loader is finished.
+	 */
+	Uint64 getJournalId() const { return journal_id; }
+
+	/**
+	 * \return The number of bytes of the journal that were replayed, or 0 if there was no journal to replay. Only
+	 *	known once the loader is finished.
+	 */
+	size_t getJournalLength() const { return journal_length; }
+
+	/**
+	 * \return true if the nbg file was in the current, binary format. If not, a new snapshot should be saved. Only
+	 *	known once the loader is finished.
+	 */
+	bool isSnapshotCurrent() const { return snapshot_current; }
+
+private:
+	//A node as read from the nbg file
+	struct SavedNode {
+		//The position of the center of the node
+		int x;
+		int y;
+
+		//The kind of node
+		NodeType type;
+	};
+
+	/**
+	 * Add a task for the workers. The caller must hold the lock.
+	 */
+	void queueTask(std::function<void()> task);
+
+	/**
+	 * A worker thread. Runs tasks until the loader is stopped.
+	 */
+	void run();
+
+	/**
+	 * List the notes in the storage, handing them off LOAD_BATCH_SIZE names at a time.
+	 */
+	void scanDirectory();
+
+	/**
+	 * Hand off a batch of names. It's turned into nodes once the positions are known, or kept until then.
+	 *
+	 * \return false if the loader is stopping, and the names were dropped
+	 */
+	bool queueNames(std::vector<std::string>&& names);
+
+	/**
+	 * Read the nbg file. A binary file is read right away, a text file has a task queued to parse each chunk of its
+	 * node lines.
+	 */
+	void readMetadata();
+
+	/**
+	 * Read the records of a binary nbg file.
+	 *
+	 * \param contents: The whole file
+	 */
+	void readBinaryMetadata(const std::string& contents);
+
+	/**
+	 * Parse the node lines between begin and end, then merge them into 'positions' if this was the last chunk.
+	 *
+	 * \param chunk: The index of the chunk in 'parsed_chunks'
+	 */
+	void parseChunk(int chunk, const char* begin, const char* end);
+
+	/**
+	 * Apply the changes saved in the journal to 'positions', 'connection_data' and the camera.
+	 */
+	void replayJournal();
+
+	/**
+	 * Merge every parsed chunk into 'positions', replay the journal, then queue the batches of names waiting for them.
+	 */
+	void finishMetadata();
+
+	/**
+	 * Turn a batch of names into nodes, and hand them to the UI thread.
+	 */
+	void buildBatch(std::vector<std::string>& names);
+
+	//The path of the graph's directory, of its nbg file, and of its journal
+	std::string graph_path;
+	std::string data_path;
+	std::string journal_path;
+
+	//The storage of the graph's notes
+	NoteStorage* storage;
+
+	//The contents of the journal. The titles replayed from it point into it
+	std::string journal;
+
+	//The id of the journal that continues from the nbg file, and the number of bytes of it replayed
+	Uint64 journal_id = 0;
+	size_t journal_length = 0;
+
+	//Indicates that the nbg file was read, and is in the binary format
+	bool snapshot_current = false;
+
+	//The contents of a text nbg file. The titles read from it point into it
+	std::string metadata;
+
+	//The contents of a binary nbg file. The titles read from it point into its string table
+	GraphFileData saved;
+
+	//The nodes read from each chunk of a text nbg file, merged into 'positions' once all of them are parsed
+	std::vector<std::vector<std::pair<std::string_view, SavedNode>>> parsed_chunks;
+
+	//The number of chunks of the nbg file still being parsed
+	int chunks_left = 0;
+
+	//Each node named in the nbg file, by title
+	std::unordered_map<std::string_view, SavedNode> positions;
+
+	//Indicates that 'positions' is complete, so batches of names can be turned into nodes
+	bool metadata_ready = false;
+
+	//The batches of names found before the positions were ready
+	std::vector<std::vector<std::string>> waiting_names;
+
+	//The titles of each pair of connected nodes
+	std::vector<std::pair<std::string_view, std::string_view>> connection_data;
+
+	//Indicates that the camera was read from the nbg file, and hasn't been taken yet
+	bool has_camera = false;
+
+	//The camera read from the nbg file
+	CameraState camera;
+
+	//The nodes read, waiting to be taken by the UI thread
+	std::vector<LoadedNode> ready;
+
+	//The number of notes found in the directory so far, and whether the whole directory has been listed
+	int found = 0;
+	bool scanned = false;
+
+	//The tasks waiting for a worker
+	std::deque<std::function<void()>> tasks;
+
+	//The number of tasks queued or running. Tasks are only queued by other tasks, so at 0 everything was read
+	int tasks_left = 0;
+
+	//Indicates that the workers should stop, even if there are tasks left
+	bool stopping = false;
+
+	//Guards everything above that's shared between the workers and the UI thread
+	std::mutex lock;
+
+	//Wakes the workers when a task is queued, and wakes wait() when the last task finishes
+	std::condition_variable changed;
+
+	//The worker threads
+	std::vector<std::thread> workers;
+
+};
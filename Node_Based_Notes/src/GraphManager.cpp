@@ -9,7 +9,7 @@ namespace fs = std::filesystem;
 
 //Initialize static public variables found in GraphManager
 SDL_Renderer* GraphManager::renderer = nullptr;
-TTF_Font* GraphManager::font = nullptr;
+FontPool* GraphManager::fonts = nullptr;
 
 /**
  * Constructor for Graphmanager. Loads SDL, TTF, requirements like window and renderer, and sets the application's
@@ -44,13 +44,41 @@ GraphManager::GraphManager() {
 		exit(0);
 	}
 
-	//Initialize the SDL_Renderer using the window
-	renderer = SDL_CreateRenderer(window, -1, 0);
+	//Initialize the SDL_Renderer using the window. Presenting waits for the display to refresh, so the window is never
+	//drawn more often than it can be shown
+	renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+	if (renderer == NULL) {
+		//fall back to any renderer at all
+		renderer = SDL_CreateRenderer(window, -1, 0);
+	}
 	if (renderer == NULL) {
 		std::cout << "Renderer could not be created. Error info: " << SDL_GetError() << std::endl;
 		exit(0);
 	}
 
+	//If the renderer can't wait for the display, render() waits for it instead
+	SDL_RendererInfo renderer_info;
+	bool has_info = SDL_GetRendererInfo(renderer, &renderer_info) == 0;
+	if (has_info && (renderer_info.flags & SDL_RENDERER_PRESENTVSYNC)) {
+		frame_interval_ms = 0;
+	}
+	else {
+		int refresh_rate = (DM.refresh_rate > 0) ? DM.refresh_rate : DEFAULT_REFRESH_RATE;
+		frame_interval_ms = 1000 / refresh_rate;
+	}
+
+	//Create the texture the graph is kept in, if the renderer can draw to one
+	if (has_info && (renderer_info.flags & SDL_RENDERER_TARGETTEXTURE)) {
+		graph_layer = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, window_shape->w, window_shape->h);
+	}
+	if (graph_layer != nullptr) {
+		//the graph covers everything behind it, so it's copied without blending
+		SDL_SetTextureBlendMode(graph_layer, SDL_BLENDMODE_NONE);
+	}
+	else {
+		std::cout << "The graph can't be cached in a texture, it will be drawn every frame." << std::endl;
+	}
+
 	//Set the renderer to blend mode, which allows for transparent graphics by modifying the alpha value of colors
 	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
 
@@ -63,15 +91,17 @@ GraphManager::GraphManager() {
 	//Start receiving SDL text input, allowing keyboard typing to be input
 	SDL_StartTextInput();
 
-	//Initialize the font with a base size of 10. This is changed each time text is rendered, so it isn't important
-	font = TTF_OpenFont(MAIN_FONT_FILENAME.c_str(), 10);
-	if (font == NULL) {
-		std::cout << "TTF Font could not be loaded." << std::endl;
-		exit(0);
-	}
+	//Open the font once for every size used, so it never has to be resized while rendering
+	fonts = new FontPool(MAIN_FONT_FILENAME, FONT_POOL_SIZES, sizeof(FONT_POOL_SIZES) / sizeof(FONT_POOL_SIZES[0]));
+
+	//Initialize the text editor scaled to the window's size, and pass it the font pool
+	text_editor = new TextEditor(window_shape->w, window_shape->h, fonts);
 
-	//Initialize the text editor scaled to the window's size, and pass it the font pointer
-	text_editor = new TextEditor(window_shape->w, window_shape->h, font);
+	//Keep the spatial index up to date whenever a node moves
+	nodes.setIndex(&node_index);
+
+	//Measure connections by the positions of the nodes in the store
+	connections.setNodes(&nodes);
 
 	//Create path to graphs in local directory if it doesn't exist
 	if (!fs::exists(GRAPH_PATH)) {
@@ -89,19 +119,23 @@ GraphManager::~GraphManager() {
 
 	//If a graph is open, save it before exiting
 	if (graph_open) {
-		closeGraph();
-
-		//And, if there is a target, the text editor was active. Save the contents of the file
-		if (target != nullptr) {
-			text_editor->close(target);
+		//If there is a target, the text editor was active. Save the contents of the file while the node still exists
+		if (getTarget() != NO_NODE) {
+			text_editor->close(nodes.getFName(getTarget()));
 		}
+
+		closeGraph();
 	}
 
 	text_editor->~TextEditor();
 	SDL_StopTextInput();
+	TextureManager::clean();
+	if (graph_layer != nullptr) {
+		SDL_DestroyTexture(graph_layer);
+	}
 	SDL_DestroyRenderer(renderer);
 	SDL_DestroyWindow(window);
-	TTF_CloseFont(font);
+	delete fonts;
 	SDL_Quit();
 	TTF_Quit();
 
@@ -170,49 +204,97 @@ void GraphManager::openGraph() {
 
 } //END OF openGraph()
 
-//Load the data for the chosen graph.
+/**
+ * Load the data for the chosen graph. The notes, nbg file and journal are read by a GraphLoader on its own threads,
+ * so this returns right away with an empty graph. The nodes are added as they're read, by takeLoadedNodes(). Changes
+ * made while loading are kept by the journal, and written once the loader is done reading it.
+ */
 void GraphManager::loadGraphData() {
-	//Start with an empty graph
-	nodes = {};
+	//Start with an empty graph, viewed from the origin
+	node_index.clear();
+	nodes.clear();
+	connections.clear();
+	camera.reset();
 
-	//Map of node metadata, i.e. names as key, and metadata as value
-	std::unordered_map<std::string, std::string> node_data = loadMetadataFromNBG();
+	load_found = 0;
+	load_scanned = false;
+	load_start_time = SDL_GetTicks();
+	storage = NoteStorage::open(graph_file_path);
+	text_editor->setStorage(storage);
+	journal = new GraphJournal(graph_file_path + GRAPH_JOURNAL_PATH, graph_file_path + GRAPH_DATA_PATH);
+	loader = new GraphLoader(graph_file_path, graph_file_path + GRAPH_DATA_PATH, graph_file_path + GRAPH_JOURNAL_PATH, storage);
 
-	//For each entry in the directory 'graph_file_path', open the file
-	for (const auto& entry : fs::directory_iterator(graph_file_path)) {
-		//If it isn't a .txt file, then skip this iteration
-		if (entry.path().extension().string() != ".txt") {
-			continue;
+	graph_open = true;
+	invalidate(LAYER_ALL);
+
+}//END OF loadGraphData()
+
+/**
+ * Add every node read since the last call. A title already in the graph is skipped, as a note created or renamed
+ * while loading can also be found in the directory. Once everything is read, the connections are made, since both
+ * ends of every connection are in the graph by then.
+ */
+void GraphManager::takeLoadedNodes(bool wait) {
+	if (wait) {
+		loader->wait();
+	}
+
+	if (loader->takeBatch(loaded_nodes)) {
+		for (const LoadedNode& node : loaded_nodes) {
+			if (loading_ids.count(node.title) == 0) {
+				addNodeToVector(node.title, node.file_name, node.x, node.y, false, node.type);
+			}
 		}
+	}
 
-		//Create a string for the name including only the name of the .txt file
-		std::string name = entry.path().string().substr(graph_file_path.size());
+	//Look where the camera was when the graph was saved, as soon as that's been read
+	CameraState saved_camera;
+	if (loader->takeCamera(&saved_camera)) {
+		camera.setState(saved_camera);
+		invalidate(LAYER_GRAPH);
+	}
 
-		//Remove the '.txt' from the name
-		name = name.substr(0, name.size() - 4);
+	//Draw the progress bar again if it changed
+	int found;
+	bool scanned;
+	loader->getProgress(&found, &scanned);
+	if (found != load_found || scanned != load_scanned) {
+		load_found = found;
+		load_scanned = scanned;
+		invalidate(LAYER_MENU);
+	}
 
-		//Create a string to store the file path
-		std::string outfile_path = entry.path().string();
+	if (!loader->isFinished()) {
+		return;
+	}
 
-		int x = 100;
-		int y = 100;
+	//Connect the nodes, skipping any connection to a note that no longer exists
+	for (const auto& pair : loader->getConnections()) {
+		auto a = loading_ids.find(std::string(pair.first));
+		auto b = loading_ids.find(std::string(pair.second));
 
-		//if the value exists in the node_metadata map
-		if (node_data.find(name) != node_data.end()) {
-			//get the metadata (currently just the position)
-			std::string pos = node_data[name];
-			x = std::stoi(pos.substr(0, pos.find(",")));
-			y = std::stoi(pos.substr(pos.find(",") + 1));
+		if (a != loading_ids.end() && b != loading_ids.end()) {
+			connections.connect(a->second, b->second);
 		}
+	}
 
-		//Add a node to the manager's vector to represent the file
-		addNodeToVector(name, outfile_path, x, y);
+	std::cout << "Loaded " << nodes.size() << " nodes in " << (SDL_GetTicks() - load_start_time) << " ms" << std::endl;
 
+	//The journal has been replayed, so new changes can be written after it. An older, text nbg file is replaced
+	journal->start(loader->getJournalId(), loader->getJournalLength());
+	if (!loader->isSnapshotCurrent()) {
+		compactGraph();
 	}
 
-	graph_open = true;
+	//The loader and titles aren't needed anymore
+	delete loader;
+	loader = nullptr;
+	std::unordered_map<std::string, NodeId>().swap(loading_ids);
+	std::vector<LoadedNode>().swap(loaded_nodes);
 
-}//END OF loadGraphData()
+	invalidate(LAYER_ALL);
+
+}//END OF takeLoadedNodes()
 
 //TODO: Comment
 void GraphManager::createNewGraph() {
@@ -232,8 +314,11 @@ void GraphManager::createNewGraph() {
 
 		//if the file doesn't exist
 		if (!fs::exists(graph_file_path)) {
-			//create the new graph
+			//create the new graph, with an empty container if new graphs are packed
 			fs::create_directory(graph_file_path);
+			if (PACK_NEW_GRAPHS) {
+				delete new PackedStorage(graph_file_path + "/");
+			}
 			break;
 		}
 		//The file already exists
@@ -281,32 +366,150 @@ void GraphManager::deleteGraph() {
 	}
 }
 
-//TODO: Comment on this
+/**
+ * Handle every event that happened since the last frame. Wait for the first one, then take the rest from the queue
+ * without waiting, so a burst of input (like moving the mouse quickly) is handled before the next render instead of
+ * one event per frame.
+ */
 void GraphManager::handleEvents() {
 	SDL_Event event;
+
+	//If the open note has unsaved edits, only wait until its autosave is due
+	int autosave_delay = (getTarget() != NO_NODE) ? text_editor->getAutosaveDelay() : -1;
+
+	//While a graph is loading, wake up often enough to add the nodes read so far
+	int wait_delay = autosave_delay;
+	if (loader != nullptr && (wait_delay < 0 || wait_delay > LOAD_POLL_INTERVAL_MS)) {
+		wait_delay = LOAD_POLL_INTERVAL_MS;
+	}
+
 	//Wait for an event to happen before proceeding. Mouse movement, keyboard input, closing the program are all events
-	SDL_WaitEvent(&event);
+	bool has_event = true;
+	if (wait_delay < 0) {
+		SDL_WaitEvent(&event);
+	}
+	else {
+		has_event = SDL_WaitEventTimeout(&event, wait_delay);
+	}
+
+	if (has_event) {
+		//Handle the first event, then every other event already waiting
+		do {
+			coalesceMouseMotion(&event);
+			handleEvent(&event);
+		} while (active && SDL_PollEvent(&event));
+	}
+	else if (getTarget() != NO_NODE && text_editor->getAutosaveDelay() == 0) {
+		//The user stopped typing, save the note in the background
+		text_editor->autosave(nodes.getFName(getTarget()));
+	}
+
+	//Add the nodes read while waiting. A menu may have closed the graph, which finishes loading it
+	if (loader != nullptr) {
+		takeLoadedNodes();
+	}
+
+	//Once the journal has grown large, save a new snapshot of the graph in the background
+	if (journal != nullptr && loader == nullptr && journal->needsCompaction()) {
+		compactGraph();
+	}
+
+}//END OF handleEvents()
+
+/**
+ * Merge mouse movements waiting in the queue into one. Only the latest position matters, but the relative movement is
+ * added up so panning still follows the mouse exactly. Stops at any other event, so clicks stay in order.
+ */
+void GraphManager::coalesceMouseMotion(SDL_Event* event) {
+	SDL_Event next;
+
+	while (event->type == SDL_MOUSEMOTION && SDL_PeepEvents(&next, 1, SDL_PEEKEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT) == 1
+		&& next.type == SDL_MOUSEMOTION) {
+		SDL_PollEvent(&next);
+		next.motion.xrel += event->motion.xrel;
+		next.motion.yrel += event->motion.yrel;
+		*event = next;
+	}
+}
+
+//Handle a single event, passing it to the camera, the text editor, or the graph.
+void GraphManager::handleEvent(SDL_Event* event) {
 
 	//if the red x was clicked, close the program. Strangely, this must be programmed in...
-	if (event.type == SDL_QUIT) {
+	if (event->type == SDL_QUIT) {
 		active = false;
 		return;
 	}
 
+	//If the window was resized, uncovered, or otherwise changed, everything has to be drawn again. The same goes if
+	//the renderer lost the contents of its textures
+	if (event->type == SDL_WINDOWEVENT || event->type == SDL_RENDER_TARGETS_RESET || event->type == SDL_RENDER_DEVICE_RESET) {
+		invalidate(LAYER_ALL);
+	}
+
 	
+	//Panning and zooming the graph come first, so a pan can continue over the text editor
+	if (handleCameraEvent(event)) {
+		return;
+	}
+
 	//if target is not null, then the text editor is open
 	//if handleTextEditorEvent returns false, the text editor wasn't the target for interaction
-	if (target == nullptr || !handleTextEditorEvent(&event)) {
+	if (getTarget() == NO_NODE || !handleTextEditorEvent(event)) {
 		//in either case, check graph for events now
-		handleGraphEvent(&event);
+		handleGraphEvent(event);
 	}
 
 	//if target was deselected somehow, update its selection status
-	if (target != nullptr) {
-		target->updateSelectStatus(true);
+	if (getTarget() != NO_NODE) {
+		nodes.updateSelectStatus(getTarget(), true);
+
+		//After enough edits, save even if the user hasn't stopped typing
+		if (text_editor->getAutosaveDelay() == 0) {
+			text_editor->autosave(nodes.getFName(getTarget()));
+		}
 	}
 
-}//END OF handle_events()
+}//END OF handleEvent()
+
+/**
+ * Pan the graph by dragging with the right mouse button, and zoom towards the mouse with the mouse wheel. Neither
+ * starts over the text editor, which uses the mouse wheel for scrolling.
+ */
+bool GraphManager::handleCameraEvent(SDL_Event* event) {
+	SDL_GetMouseState(&mousex, &mousey);
+
+	bool over_editor = getTarget() != NO_NODE && isWithin(mousex, mousey, 0, 0, text_editor->getShape()->w, text_editor->getShape()->h);
+
+	//Start panning when the right mouse button is pressed over the graph
+	if (event->type == SDL_MOUSEBUTTONDOWN && event->button.button == SDL_BUTTON_RIGHT && !over_editor) {
+		panning = true;
+		return true;
+	}
+
+	//Stop panning when it's released
+	if (event->type == SDL_MOUSEBUTTONUP && event->button.button == SDL_BUTTON_RIGHT && panning) {
+		panning = false;
+		return true;
+	}
+
+	//While panning, the graph follows the mouse
+	if (event->type == SDL_MOUSEMOTION && panning) {
+		camera.pan(event->motion.xrel, event->motion.yrel);
+		invalidate(LAYER_GRAPH);
+		return true;
+	}
+
+	//Zoom in or out by a step for each notch the wheel turned
+	if (event->type == SDL_MOUSEWHEEL && !over_editor) {
+		camera.zoomAt(mousex, mousey, std::pow(CAMERA_ZOOM_STEP, (float)event->wheel.y));
+		invalidate(LAYER_GRAPH);
+		return true;
+	}
+
+	return false;
+
+}//END OF handleCameraEvent()
 
 /**
  * Handle events that relate to the graph, as opposed to the text editor.
@@ -322,7 +525,12 @@ void GraphManager::handleGraphEvent(SDL_Event* event) {
 			//Exit the program. In the future, this will instead open a main menu
 			std::cout << "Escape" << std::endl;
 			int choice = runButtonMenu("Graph Editor Paused.",
-				{"Return to Menu", "Save and Exit"});
+				{"Return to Menu", "Save and Exit", storage->isPacked() ? "Unpack notes into files" : "Pack notes into one file"});
+			if (choice == 2) {
+				//Move the notes to the other storage, then keep editing
+				convertStorage();
+				break;
+			}
 			if (choice == 0) {
 				//Return to main menu
 				closeGraph();
@@ -361,31 +569,37 @@ void GraphManager::handleGraphEvent(SDL_Event* event) {
 	int mouse_flags = SDL_GetMouseState(&mousex, &mousey);
 
 	//Test if hovering over an object
-	Node* current_target = detectNodeUnderMouse(mousex, mousey);
+	NodeId current_target = detectNodeUnderMouse(mousex, mousey);
 
-	//Update graphics of hovered and selected nodes
+	//Update graphics of hovered and selected nodes, but only if the node under the mouse changed
+	if (current_target != getHoverTarget()) {
+		//The old hover target isn't under the mouse anymore
+		if (getHoverTarget() != NO_NODE) {
+			nodes.updateHoverStatus(getHoverTarget(), false);
+		}
 
-	//If current target is not null, then you are hovering over a node
-	if (current_target != nullptr) {
-		hover_target = current_target;
-		hover_target->updateHoverStatus(true);
-	}//if current target is null, then there is nothing to hover over
-	else if (hover_target != nullptr) {
-		//Update the hover target's graphics to show it isn't hovered over
-		hover_target->updateHoverStatus(false);
+		//If current target is not null, then you are hovering over a node. It may be clicked next, so read it ahead
+		if (current_target != NO_NODE) {
+			nodes.updateHoverStatus(current_target, true);
+			text_editor->prefetch(nodes.getFName(current_target));
+		}
 
-		//Remove access to the expired hover target
-		hover_target = nullptr;
+		hover_target = (current_target != NO_NODE) ? nodes.getHandle(current_target) : NO_HANDLE;
+		invalidate(LAYER_GRAPH);
 	}
 
 	//If a mouse button was pressed, and it was the left button
 	if (event->type == SDL_MOUSEBUTTONDOWN && event->button.button == SDL_BUTTON_LEFT) {
 		//If the current target is not null
-		if (current_target != nullptr) {
+		if (current_target != NO_NODE) {
+			//Shift-clicking another node connects it to the target (or disconnects them), without opening it
+			if ((SDL_GetModState() & KMOD_SHIFT) && getTarget() != NO_NODE && getTarget() != current_target) {
+				connectNodes(getTarget(), current_target);
+			}
 			//and the target is not the current target
-			if (target != current_target) {
+			else if (getTarget() != current_target) {
 				//If there was a target previously
-				if (target != nullptr) {
+				if (getTarget() != NO_NODE) {
 					//Update the old target, which is no longer selected, and save the file
 					deselectTargetNode();
 				}
@@ -395,14 +609,16 @@ void GraphManager::handleGraphEvent(SDL_Event* event) {
 			}
 
 			//print out the title of the target node when clicked
-			std::cout << "Node clicked. Title: " << target->getTitle() << std::endl;
+			std::cout << "Node clicked. Title: " << nodes.getTitle(getTarget()) << std::endl;
 		}//The current target was null
 		else if (event->button.clicks == 2) { //If there were two clicks
 			//Make a new node
 			std::cout << "Double click, no collision? Make a new node!" << std::endl;
 
 			//Create a new node for this graph centered on the mouse position
-			createNode(mousex, mousey);
+			int world_x, world_y;
+			camera.screenToWorld(mousex, mousey, &world_x, &world_y);
+			createNode(world_x, world_y);
 
 		}//It was a single click hovering over empty space
 		else {
@@ -410,17 +626,47 @@ void GraphManager::handleGraphEvent(SDL_Event* event) {
 			std::cout << "Nothing under mouse on click." << std::endl;
 
 			//If there was a target, remove it
-			if (target != nullptr) {
+			if (getTarget() != NO_NODE) {
 				deselectTargetNode();
 			}
 		}
+	}//Else if the mouse moved with the left mouse button held
+	else if (event->type == SDL_MOUSEMOTION && (event->motion.state & SDL_BUTTON_LMASK) != 0) {
+		//If there is a target, and the drag isn't connecting it to another node
+		if (getTarget() != NO_NODE && !(SDL_GetModState() & KMOD_SHIFT)) {
+			//The target follows the mouse. The move is journaled once, when the button is released
+			int world_x, world_y;
+			camera.screenToWorld(mousex, mousey, &world_x, &world_y);
+			SDL_Rect old_shape = nodes.getShape(getTarget());
+			nodes.setPos(getTarget(), world_x, world_y);
+			connections.nodeMoved(getTarget());
+			invalidate(LAYER_GRAPH);
+
+			SDL_Rect shape = nodes.getShape(getTarget());
+			if (shape.x != old_shape.x || shape.y != old_shape.y) {
+				dragging_target = true;
+			}
+		}
 	}//Else if a mouse button was released, and it was the left mouse button
-	else if (event->type = SDL_MOUSEBUTTONUP && event->button.button == SDL_BUTTON_LEFT) {
-		//If there is a target
-		if (target != nullptr) {
-			//Move the target to where the mouse is
-			target->setPos(mousex, mousey);
+	else if (event->type == SDL_MOUSEBUTTONUP && event->button.button == SDL_BUTTON_LEFT) {
+		//If there is a target, and the click wasn't connecting it to another node
+		if (getTarget() != NO_NODE && !(SDL_GetModState() & KMOD_SHIFT)) {
+			//Move the target to where the mouse is in the graph
+			int world_x, world_y;
+			camera.screenToWorld(mousex, mousey, &world_x, &world_y);
+			SDL_Rect old_shape = nodes.getShape(getTarget());
+			nodes.setPos(getTarget(), world_x, world_y);
+			connections.nodeMoved(getTarget());
+			invalidate(LAYER_GRAPH);
+
+			//Only save the move if the node actually moved, while it was dragged or just now
+			SDL_Rect shape = nodes.getShape(getTarget());
+			if (dragging_target || shape.x != old_shape.x || shape.y != old_shape.y) {
+				journal->moveNode(nodes.getTitle(getTarget()), world_x, world_y);
+			}
 		}
+
+		dragging_target = false;
 	}
 
 }//END OF handleGraphEvent()
@@ -434,6 +680,11 @@ bool GraphManager::handleTextEditorEvent(SDL_Event* event) {
 	//get mouse location
 	int mouse_flags = SDL_GetMouseState(&mousex, &mousey);
 
+	//If the text editor was scrolled, with the mouse wheel or scroll bar
+	if (text_editor->handleMouseEvent(event, mousex, mousey)) {
+		return true;
+	}
+
 	//If a key was pressed, or text input was detected
 	if (event->type == SDL_KEYDOWN || event->type == SDL_TEXTINPUT) {
 
@@ -441,8 +692,8 @@ bool GraphManager::handleTextEditorEvent(SDL_Event* event) {
 		if (event->key.keysym.sym == SDLK_ESCAPE) {
 			deselectTargetNode();
 		}
-		//If the key was delete, ask to delete this Node
-		else if (event->key.keysym.sym == SDLK_DELETE) {
+		//If the key was ctrl+delete, ask to delete this Node. Delete on its own deletes text in the editor
+		else if (event->type == SDL_KEYDOWN && event->key.keysym.sym == SDLK_DELETE && (event->key.keysym.mod & KMOD_CTRL) != 0) {
 			promptDeleteNode();
 		}
 		else {
@@ -463,7 +714,24 @@ bool GraphManager::handleTextEditorEvent(SDL_Event* event) {
 			//rename the node
 			if (result == 0) {
 				std::string new_title = ensureUniqueNodeName(*runTextMenu("Rename the Node."), "Rename the Node.");
-				target->setTitle(new_title);
+
+				//The file must be completely saved before it's moved, or a late save would recreate the old file
+				text_editor->finishSaving(nodes.getFName(getTarget()));
+				std::string old_title = nodes.getTitle(getTarget());
+				std::string old_path = nodes.getFName(getTarget());
+				nodes.setTitle(getTarget(), new_title);
+				connections.nodeMoved(getTarget());
+				journal->renameNode(old_title, new_title);
+
+				//move the note to match its new title
+				if (!storage->rename(old_path, nodes.getFName(getTarget()))) {
+					std::cout << "Issue: Node's file was not renamed." << std::endl;
+				}
+
+				//The renamed file may not have been listed yet, so the loader mustn't add it again
+				if (loader != nullptr) {
+					loading_ids[new_title] = getTarget();
+				}
 			}
 			//delete the node
 			else if (result == 1) {
@@ -483,52 +751,195 @@ bool GraphManager::handleTextEditorEvent(SDL_Event* event) {
 }//END OF handleTextEditorEvent()
 
 /**
- * Render the graph, and the text editor if a target is currently selected.
+ * Render the graph, and the text editor if a target is currently selected. Nothing is drawn unless something was
+ * invalidated since the last frame, so an idle window costs nothing. The graph is kept in a texture, so typing in the
+ * text editor or opening a menu only copies it instead of drawing every node again. Nodes outside of the camera's view are
+ * never drawn, so the cost of a frame depends on how many nodes can be seen rather than the size of the graph.
  */
 void GraphManager::render() {
 
+	//If nothing changed since the last frame, the window already shows the right thing
+	if (dirty_layers == 0 && (getTarget() == NO_NODE || !text_editor->needsRedraw())) {
+		return;
+	}
+
+	//Without vsync, don't draw again until the display has refreshed since the last frame
+	if (frame_interval_ms > 0) {
+		Uint32 elapsed = SDL_GetTicks() - last_frame_time;
+		if (elapsed < (Uint32)frame_interval_ms) {
+			SDL_Delay(frame_interval_ms - elapsed);
+		}
+	}
+
 	//Clear the text from the renderer
 	SDL_RenderClear(renderer);
 
-	//Render graph background
-	Custom_SDLDrawRect(renderer, &GRAPH_BACKGROUND_COLOR, window_shape->x, window_shape->y, window_shape->w, window_shape->h);
+	if (graph_layer == nullptr) {
+		renderGraph();
+	}
+	else {
+		//Only draw the graph again if it changed, otherwise the copy from the last change is still right
+		if (dirty_layers & LAYER_GRAPH) {
+			SDL_SetRenderTarget(renderer, graph_layer);
+			renderGraph();
+			SDL_SetRenderTarget(renderer, nullptr);
+		}
 
-	//Render all nodes in the vector
-	for (int i = 0; i < nodes.size(); i++) {
-		nodes.at(i)->render(renderer);
+		SDL_RenderCopy(renderer, graph_layer, nullptr, window_shape);
 	}
 
 	//If there is a target
-	if (target != nullptr) {
+	if (getTarget() != NO_NODE) {
 		//Render the text editor
-		text_editor->render(renderer, target);
+		text_editor->render(renderer, nodes.getTitle(getTarget()));
+	}
+
+	//While the graph is loading, show how far along it is
+	if (loader != nullptr) {
+		renderLoadProgress();
 	}
 
 	//Present the renderer after everything was loaded in
 	SDL_RenderPresent(renderer);
+	last_frame_time = SDL_GetTicks();
+
+	//Everything is up to date until the next change
+	dirty_layers = 0;
 
 }//END OF render()
 
 /**
- * Creates a Node object, and adds it to the vector of nodes active in this graph. All details for the Node are
- * passed in as parameters.
+ * Draw the progress bar over the bottom of the window. Until the directory has been listed the total isn't known, so
+ * only the count found so far is written, and the bar fills once there's a total to fill it by.
  */
-void GraphManager::addNodeToVector(std::string title, std::string file_name, int x_pos, int y_pos, bool creating_new_node) {
-	//Create a temporary node defined by parameters
-	Node* temp = new Node(title, file_name, x_pos, y_pos);
+void GraphManager::renderLoadProgress() {
+	SDL_Rect track = { 0, window_shape->h - LOAD_BAR_HEIGHT, window_shape->w, LOAD_BAR_HEIGHT };
+	Custom_SDLDrawRect(renderer, &LOAD_BAR_TRACK_COLOR, &track);
 
-	//Add the node to the vector
-	nodes.push_back(temp);
+	std::string message;
+	if (load_scanned) {
+		int loaded = std::min(nodes.size(), load_found);
+		int filled = (load_found > 0) ? (int)((long long)track.w * loaded / load_found) : track.w;
+		Custom_SDLDrawRect(renderer, &LOAD_BAR_COLOR, track.x, track.y, filled, track.h);
+
+		message = "Loading graph: " + std::to_string(loaded) + " of " + std::to_string(load_found) + " notes";
+	}
+	else {
+		message = "Loading graph: " + std::to_string(load_found) + " notes found";
+	}
+
+	TextureManager::loadWrappedText(renderer, fonts, message.c_str(), &WHITE, track.x, track.y + (track.h - LOAD_FONT_SIZE) / 2, track.w, LOAD_FONT_SIZE, true);
+}
+
+//Draw the background, then the nodes the camera can see (or their clusters, when zoomed out).
+void GraphManager::renderGraph() {
+	//Render graph background
+	Custom_SDLDrawRect(renderer, &GRAPH_BACKGROUND_COLOR, window_shape->x, window_shape->y, window_shape->w, window_shape->h);
+
+	//Find the nodes the camera can see. Hovered and selected nodes grow, so look a little past the edges
+	SDL_Rect view = camera.getViewRect(window_shape->w, window_shape->h);
+	view = { view.x - NODE_SIZE_INCREASE, view.y - NODE_SIZE_INCREASE, view.w + NODE_SIZE_INCREASE * 2, view.h + NODE_SIZE_INCREASE * 2 };
+
+	if (camera.getZoom() < CLUSTER_ZOOM_THRESHOLD) {
+		//Zoomed out too far to see single nodes, draw a block for each cluster instead
+		renderClusters(view);
+	}
+	else {
+		//Connections are drawn first, so the nodes cover their ends
+		connections.render(renderer, node_index, camera, view);
+
+		node_index.queryRect(view, visible_nodes);
+
+		//Queue only the visible nodes, then draw them with one call for each color
+		for (int i = 0; i < (int)visible_nodes.size(); i++) {
+			nodes.render(visible_nodes.at(i), &node_batch, camera);
+		}
+		node_batch.flush(renderer);
+	}
+
+}//END OF renderGraph()
+
+/**
+ * Draw the graph as clusters. Each cluster is shaded by how many nodes it holds, with the shades doubling in count, so
+ * both sparse and very dense areas can be told apart. The clusters of each shade are drawn with one call, and the
+ * count is written on clusters big enough to fit it. The selected and hovered nodes are still drawn on top, so they
+ * aren't lost while zoomed out.
+ */
+void GraphManager::renderClusters(const SDL_Rect& view) {
+	node_index.queryClusters(view, visible_clusters);
+
+	for (int i = 0; i < CLUSTER_SHADE_COUNT; i++) {
+		cluster_rects[i].clear();
+	}
+
+	for (const Cluster& cluster : visible_clusters) {
+		//the shade is the number of times the count can be halved
+		int shade = 0;
+		while (shade < CLUSTER_SHADE_COUNT - 1 && (cluster.count >> (shade + 1)) > 0) {
+			shade++;
+		}
+
+		cluster_rects[shade].push_back(camera.worldToScreen(cluster.bounds));
+	}
+
+	//Draw each shade, from the most transparent up to CLUSTER_COLOR
+	for (int i = 0; i < CLUSTER_SHADE_COUNT; i++) {
+		if (cluster_rects[i].empty()) {
+			continue;
+		}
+
+		Uint8 alpha = (Uint8)(CLUSTER_COLOR.a * (i + 1) / CLUSTER_SHADE_COUNT);
+		SDL_SetRenderDrawColor(renderer, CLUSTER_COLOR.r, CLUSTER_COLOR.g, CLUSTER_COLOR.b, alpha);
+		SDL_RenderFillRects(renderer, cluster_rects[i].data(), (int)cluster_rects[i].size());
+	}
+
+	//Write the counts, if the clusters are big enough on screen to read them
+	int cluster_width = (int)(CLUSTER_CELL_SIZE * camera.getZoom());
+	if (cluster_width >= CLUSTER_LABEL_MIN_WIDTH) {
+		for (const Cluster& cluster : visible_clusters) {
+			SDL_Rect rect = camera.worldToScreen(cluster.bounds);
+			TextureManager::loadCachedWrappedText(renderer, fonts, std::to_string(cluster.count), &WHITE, rect.x, rect.y + (rect.h - CLUSTER_FONT_SIZE) / 2, rect.w, CLUSTER_FONT_SIZE, true);
+		}
+	}
+
+	//The nodes the user is working with stay visible
+	if (getHoverTarget() != NO_NODE && hover_target != target) {
+		nodes.render(getHoverTarget(), &node_batch, camera);
+	}
+	if (getTarget() != NO_NODE) {
+		nodes.render(getTarget(), &node_batch, camera);
+	}
+	node_batch.flush(renderer);
+
+}//END OF renderClusters()
+
+/**
+ * Adds a node to the store of nodes active in this graph. All details for the node are passed in as parameters.
+ */
+NodeId GraphManager::addNodeToVector(std::string title, std::string file_name, int x_pos, int y_pos, bool creating_new_node, NodeType type) {
+	//Add the node to the store, and to the spatial index so it can be found under the mouse
+	NodeId temp = nodes.add(title, file_name, x_pos, y_pos, type);
+	node_index.insert(temp, nodes.getShape(temp));
+	invalidate(LAYER_GRAPH);
+
+	//While the graph is loading, remember the title so the loader doesn't add the same note again
+	if (loader != nullptr) {
+		loading_ids[title] = temp;
+	}
 
 	//If this Node was created during runtime
 	if (creating_new_node) {
+		journal->addNode(title, x_pos, y_pos, type);
+
 		//Open the node, displaying the text editor
 		openTargetNode(temp);
 
 		//This node is also being hovered over, as it was just created under the mouse
-		hover_target = temp;
+		hover_target = nodes.getHandle(temp);
 	}
 
+	return temp;
+
 }//END OF addNode()
 
 void GraphManager::createNode(int x_pos, int y_pos) {
@@ -537,11 +948,10 @@ void GraphManager::createNode(int x_pos, int y_pos) {
 	std::string response = ensureUniqueNodeName(*runTextMenu("Name the new node."), "Name the new node.");
 	std::string file_path = graph_file_path + response + ".txt";
 
-	//Open an out file stream at the file_path
-	std::ofstream outfile(file_path);
-
-	//Close the output file
-	outfile.close();
+	//Create the empty note
+	if (!storage->write(file_path, StringSnapshot(""))) {
+		std::cout << "ERROR: The new node's file could not be created. Path: " << file_path << std::endl;
+	}
 
 	addNodeToVector(response, file_path, x_pos, y_pos, true);
 
@@ -549,26 +959,33 @@ void GraphManager::createNode(int x_pos, int y_pos) {
 
 
 /**
- * Find a node at the position of the mouse coordinates.
- * Returns nullptr if no such Node exists.
+ * Toggle the connection between two nodes. The graph is drawn again either way, since a line appeared or disappeared.
  */
-Node* GraphManager::detectNodeUnderMouse(int mousex, int mousey) {
-
-	//For every Node in the vector
-	for (int i = 0; i < nodes.size(); i++) {
-		//Get the SDL_Rect for the Node
-		SDL_Rect* node_shape = nodes.at(i)->getShape();
-
-		//Long story short, if the mouse coordinates are inside of the Node's boundaries
-		if (mousex > node_shape->x && mousex < node_shape->x + node_shape->w
-			&& mousey > node_shape->y && mousey < node_shape->y + node_shape->h) {
-			//Return that Node
-			return nodes.at(i);
-		}
+void GraphManager::connectNodes(NodeId a, NodeId b) {
+	if (connections.connect(a, b)) {
+		std::cout << "Connected " << nodes.getTitle(a) << " to " << nodes.getTitle(b) << std::endl;
+		journal->connectNodes(nodes.getTitle(a), nodes.getTitle(b));
+	}
+	else if (connections.disconnect(a, b)) {
+		std::cout << "Disconnected " << nodes.getTitle(a) << " from " << nodes.getTitle(b) << std::endl;
+		journal->disconnectNodes(nodes.getTitle(a), nodes.getTitle(b));
 	}
 
-	//No node was found, return nullptr
-	return nullptr;
+	invalidate(LAYER_GRAPH);
+}
+
+/**
+ * Find a node at the position of the mouse coordinates, using the spatial index.
+ * Returns NO_NODE if no such Node exists.
+ */
+NodeId GraphManager::detectNodeUnderMouse(int mousex, int mousey) {
+
+	//Find the point in the graph under the mouse
+	int world_x, world_y;
+	camera.screenToWorld(mousex, mousey, &world_x, &world_y);
+
+	//Only the nodes in the grid cell under the mouse are checked. If nodes overlap, the one drawn on top is returned
+	return node_index.queryPoint(world_x, world_y);
 
 }//END OF detectNodeUnderMouse()
 
@@ -576,25 +993,46 @@ Node* GraphManager::detectNodeUnderMouse(int mousex, int mousey) {
  * Deselect the target node, closing the text editor aswell
  */
 void GraphManager::deselectTargetNode() {
-	//Close the text editor, saving data to file stored in target
-	text_editor->close(target);
+	NodeId id = getTarget();
 
-	//Deselect target (graphics)
-	target->deselect();
+	//A stale target has no file or graphics left to update, just close the text editor
+	if (id == NO_NODE) {
+		std::cout << "The selected node no longer exists." << std::endl;
+		text_editor->close();
+	}
+	else {
+		//Close the text editor, saving data to file stored in target
+		text_editor->close(nodes.getFName(id));
+
+		//Deselect target (graphics). It's no longer hovered either, until the mouse moves over it again
+		nodes.deselect(id);
+	}
+
+	if (hover_target == target) {
+		hover_target = NO_HANDLE;
+	}
+	invalidate(LAYER_ALL);
 
 	//Set the target to be null, now that it's closed
-	target = nullptr;
+	target = NO_HANDLE;
 
 }
 
 /**
- * Open a target node, along with the text editor
+ * Open a target node, along with the text editor. The nodes connected to it are the likeliest to be opened next, so
+ * they're read ahead in the background.
  */
-void GraphManager::openTargetNode(Node* new_target) {
-	target = new_target;
+void GraphManager::openTargetNode(NodeId new_target) {
+	target = nodes.getHandle(new_target);
 
 	//Open the text editor, loading the file stored in the Node object
-	text_editor->open(target);
+	text_editor->open(nodes.getFName(getTarget()));
+	invalidate(LAYER_ALL);
+
+	connections.getNeighbors(new_target, neighbors);
+	for (NodeId neighbor : neighbors) {
+		text_editor->prefetch(nodes.getFName(neighbor));
+	}
 
 }
 
@@ -607,11 +1045,15 @@ std::string* GraphManager::runTextMenu(std::string message) {
 	}
 
 	//render the background again
+	invalidate(LAYER_MENU);
 	render();
 
 	TextMenu* text_menu = new TextMenu(window_shape->w, window_shape->h, window_shape->w / MENU_WIDTH_DENOM, message.c_str());
 	std::string* response = text_menu->waitEvent(renderer);
 
+	//The menu was drawn over everything, so the window has to be put back together (the graph itself didn't change)
+	invalidate(LAYER_MENU);
+
 	if (response == nullptr) {
 		//quit the program
 		active = false;
@@ -629,12 +1071,16 @@ int GraphManager::runButtonMenu(std::string message, std::vector<std::string> bu
 		return -1;
 	}
 	//render the background
+	invalidate(LAYER_MENU);
 	render();
 
 	//create a new button menu
 	ButtonMenu* button_menu = new ButtonMenu(window_shape->w, window_shape->h, window_shape->w / MENU_WIDTH_DENOM, message.c_str(), buttons, add_exit);
 	int result = button_menu->waitEvent(renderer);
 
+	//The menu was drawn over everything, so the window has to be put back together (the graph itself didn't change)
+	invalidate(LAYER_MENU);
+
 	if (result == -1) {
 		active = false;
 	}
@@ -655,34 +1101,122 @@ void GraphManager::fixGraphFilePath() {
 	graph_file_path = GRAPH_PATH + graph_file_path;
 }
 
+/**
+ * Close the open graph. Every change was saved to the journal as it was made, so only the camera is left to save,
+ * and closing costs nothing more however large the graph is.
+ */
 void GraphManager::closeGraph() {
-	std::string nbg_path = graph_file_path + GRAPH_DATA_PATH;
+	//Every node has to be loaded before the graph is closed, so the journal is replayed before it's written to
+	if (loader != nullptr) {
+		takeLoadedNodes(true);
+	}
+
+	journal->saveCamera(camera.getState());
+	if (journal->needsCompaction()) {
+		compactGraph();
+	}
+
+	//Wait for the journal to finish writing, so nothing is lost if the program exits next
+	delete journal;
+	journal = nullptr;
+
+	//Every save has been written by now, as the text editor waits for them before letting go of the storage
+	text_editor->setStorage(nullptr);
+	delete storage;
+	storage = nullptr;
 
-	//Open this object's nbg file
-	std::ofstream outfile(nbg_path, std::ofstream::trunc);
+	//Clear the node store and spatial index for future use, freeing their memory. No node is hovered or selected
+	node_index.clear();
+	nodes.clear();
+	connections.clear();
+	target = hover_target = NO_HANDLE;
 
-	//If it opened successfully, save the position of each node
-	if (outfile.good()) {
+	graph_open = false;
+	invalidate(LAYER_ALL);
+}
 
-		//For each node, write the title, x, and y to the file followed by a line break
-		for (int i = 0; i < nodes.size(); i++) {
-			Node* temp = nodes.at(i);
-			outfile << temp->getTitle() << " at " << temp->getShape()->x << "," << temp->getShape()->y << std::endl;
+/**
+ * Collect everything saved about the graph. Only the copy is made here, the journal writes it on its own thread.
+ */
+void GraphManager::compactGraph() {
+	//Each node is saved by its center, which is what it's added by
+	GraphFileData data;
+	std::vector<Uint32> file_index(nodes.getSlotCount());
+	for (NodeId id = 0; id < nodes.getSlotCount(); id++) {
+		//skip the slots of deleted nodes
+		if (!nodes.contains(id)) {
+			continue;
 		}
 
+		SDL_Rect shape = nodes.getShape(id);
+		file_index[id] = (Uint32)data.nodes.size();
+		data.addNode(nodes.getTitle(id), shape.x + shape.w / 2, shape.y + shape.h / 2, nodes.getType(id));
+	}
+
+	//Connections are saved by the index of each node in the file, as the slots of deleted nodes were skipped
+	for (const Connection& connection : connections.getConnections()) {
+		data.connections.push_back({ file_index[connection.a], file_index[connection.b] });
 	}
+
+	data.has_camera = true;
+	data.camera = camera.getState();
+
+	journal->compact(std::move(data));
+
+}//END OF compactGraph()
+
+/**
+ * Copy every note into the other kind of storage, then delete them from the old one. The old storage is only cleared
+ * once every note has been copied, so a failed copy leaves the graph as it was. Nodes already loaded keep their file
+ * paths, as notes are found by the same paths in either storage.
+ */
+void GraphManager::convertStorage() {
+	//Every note has to be listed before it can be copied
+	if (loader != nullptr) {
+		takeLoadedNodes(true);
+	}
+
+	//Save the open note, and stop the background threads from using the old storage
+	if (getTarget() != NO_NODE) {
+		text_editor->finishSaving(nodes.getFName(getTarget()));
+	}
+	text_editor->setStorage(nullptr);
+
+	Uint32 start_time = SDL_GetTicks();
+	NoteStorage* converted = nullptr;
+	bool copied;
+	if (storage->isPacked()) {
+		converted = new DirectoryStorage(graph_file_path);
+		copied = NoteStorage::copyNotes(*storage, *converted, graph_file_path);
+	}
+	//The container is built on the side, and only opened once it's complete
 	else {
-		std::cout << "ERROR: The Node metadata could not be saved upon exiting." << std::endl;
+		copied = PackedStorage::pack(*storage, graph_file_path);
+		if (copied) {
+			converted = new PackedStorage(graph_file_path);
+		}
 	}
 
-	//close the file
-	outfile.close();
+	if (copied) {
+		storage->clear();
+		delete storage;
+		storage = converted;
 
-	//Clear the node vector for future use
-	nodes.clear();
+		std::cout << (storage->isPacked() ? "Packed " : "Unpacked ") << nodes.size() << " notes in "
+			<< (SDL_GetTicks() - start_time) << " ms" << std::endl;
+	}
+	//Throw away the partial copy, and keep using the old storage
+	else {
+		std::cout << "ERROR: The notes could not be moved. They were left where they were." << std::endl;
+		if (converted != nullptr) {
+			converted->clear();
+			delete converted;
+		}
+	}
 
-	graph_open = false;
-}
+	text_editor->setStorage(storage);
+
+}//END OF convertStorage()
 
 int GraphManager::promptGraphSelection(std::string message) {
 	std::vector<std::string> graph_directories;
@@ -722,28 +1256,45 @@ int GraphManager::promptGraphSelection(std::string message) {
 }
 
 void GraphManager::promptDeleteNode() {
+	NodeId id = getTarget();
+
+	//There's nothing to delete if the target is already gone
+	if (id == NO_NODE) {
+		return;
+	}
 
 	//If they don't want to delete the node, then return
-	if (runVerifyButtonMenu("Are you sure you would like to delete " + target->getTitle() + "?") == 1) {
+	if (runVerifyButtonMenu("Are you sure you would like to delete " + nodes.getTitle(id) + "?") == 1) {
 		return;
 	}
 
-	//delete the node from the vector
-	nodes.erase(std::remove(nodes.begin(), nodes.end(), target), nodes.end());
+	//Any save still waiting would recreate the file, so cancel it first
+	text_editor->cancelSaving(nodes.getFName(id));
 
 	//delete the file
-	fs::path to_delete = target->getFName();
-	bool result = fs::remove(to_delete);
-	if (!result) {
-		std::cout << "Something went wrong deleting the directory. Path: " + target->getFName();
+	if (!storage->remove(nodes.getFName(id))) {
+		std::cout << "Something went wrong deleting the directory. Path: " + nodes.getFName(id);
 		exit(0);
 	}
 
+	//delete the node's connections, then the node from the spatial index and the store. Any handle to it is now stale
+	if (loader != nullptr) {
+		loading_ids.erase(nodes.getTitle(id));
+	}
+	journal->deleteNode(nodes.getTitle(id));
+	connections.removeNode(id);
+	node_index.remove(id);
+	nodes.remove(id);
+
 	//Close the text editor without saving (as the file is deleted)
 	text_editor->close();
 
 	//Make the target null, as it doesn't exist anymore
-	target = nullptr;
+	if (hover_target == target) {
+		hover_target = NO_HANDLE;
+	}
+	target = NO_HANDLE;
+	invalidate(LAYER_ALL);
 
 }
 
@@ -753,8 +1304,8 @@ void GraphManager::promptDeleteNode() {
  */
 std::string GraphManager::ensureUniqueNodeName(std::string node_name, std::string message) {
 
-	//While a node exists in the graph directory with that name
-	while (fs::exists(graph_file_path + node_name + ".txt")) {
+	//While a node exists in the graph with that name
+	while (storage->exists(graph_file_path + node_name + ".txt")) {
 		//Prompt the user for a new name for the node
 		node_name = *runTextMenu("That node already exists.\n" + message);
 	}
@@ -762,45 +1313,3 @@ std::string GraphManager::ensureUniqueNodeName(std::string node_name, std::strin
 	return node_name;
 
 }
-
-//commentodo
-std::unordered_map<std::string, std::string> GraphManager::loadMetadataFromNBG() {
-	std::ifstream node_file;
-	std::string line;
-
-	std::unordered_map<std::string, std::string> data;
-
-	//Open the nbg file for this graph
-	node_file.open(graph_file_path + GRAPH_DATA_PATH);
-
-	//If opened successfully
-	if (node_file.is_open()) {
-
-		//While there are lines left in node_file
-		while (node_file.good()) {
-
-			//Copy the next line of text
-			std::getline(node_file, line);
-
-			//Quit if the line is empty
-			if (line.empty()) { break; }
-
-			//Separate the name and metadata of the node
-			std::string name = line.substr(0, line.find(" at "));
-			std::string metadata = line.substr(line.find(" at ") + 4);
-
-			data[name] = metadata;
-
-		}
-
-	}
-	else {
-		std::cout << "Couldn't open graph data. Using default positions." << std::endl;
-	}
-
-	node_file.close();
-
-	return data;
-
-}
-
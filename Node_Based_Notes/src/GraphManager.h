@@ -4,7 +4,7 @@
  * 
  * GraphManager: 
  *	* Loads all utilities, including SDL and TTF
- *  * Contains SDL tools including the renderer and font(s), and cleans them when the program is closed
+ *  * Contains SDL tools including the renderer and fonts, and cleans them when the program is closed
  *  * Describes the life of the program (if !active, the program will end)
  *  * Manages the TextEditor, and contains pointers to all Nodes
  *  * Handles events during runtime (user interaction such as keyboard or mouse inputs)
@@ -16,7 +16,15 @@
 #include "Config.h"
 #include "Utils.h"
 
-#include "Node.h"
+#include "NodeStore.h"
+#include "SpatialGrid.h"
+#include "ConnectionStore.h"
+#include "GraphLoader.h"
+#include "GraphFile.h"
+#include "GraphJournal.h"
+#include "NoteStorage.h"
+#include "DirectoryStorage.h"
+#include "PackedStorage.h"
 #include "TextureManager.h"
 #include "TextEditor.h"
 #include "ButtonMenu.h"
@@ -25,6 +33,15 @@
 #include <unordered_map>
 
 
+//The layers drawn in the window. A layer is marked with invalidate() when something in it changes
+//The graph is kept in a texture between frames, so only a change to LAYER_GRAPH draws the nodes again
+enum RenderLayer {
+	LAYER_GRAPH = 1,
+	LAYER_EDITOR = 2,
+	LAYER_MENU = 4,
+	LAYER_ALL = LAYER_GRAPH | LAYER_EDITOR | LAYER_MENU
+};
+
 class GraphManager {
 public:
 	/**
@@ -35,7 +52,7 @@ public:
 	 * 4. Set SDL_Renderer to blend mode, to allow rendering of transparent objects
 	 * 5. Initialize TTF
 	 * 6. Start accepting SDL text input
-	 * 7. Open the font and store within this object
+	 * 7. Open the font at every size used, and store the pool within this object
 	 * 8. Initialize the text_editor using the shape of the SDL_Window
 	 * 9. Create a "Graphs/" directory if it doesn't already exist
 	 */
@@ -56,8 +73,8 @@ public:
 	//The SDL renderer used by this program
 	static SDL_Renderer* renderer;
 
-	//The only TTF font used by this program
-	static TTF_Font* font;
+	//The fonts used by this program, one for each font size
+	static FontPool* fonts;
 
 	/**
 	 * Open a graph from the "Graphs/" directory. Given user input, load a specific directory to nodes displayed
@@ -66,20 +83,30 @@ public:
 	void openGraph();
 
 	/*
-	 * A helper function to openGraph(), this is the backend which loads the data of the selected graph.
+	 * A helper function to openGraph(), this is the backend which loads the data of the selected graph. The graph is
+	 * read in the background, and its nodes appear as they're read.
 	 */
 	void loadGraphData();
 
 	/**
-	 * Handle events, i.e. user inputs to the program during runtime.
+	 * Handle events, i.e. user inputs to the program during runtime. Waits for an event, then handles every event
+	 * waiting in the queue, so render() is called once for all of them.
 	 */
 	void handleEvents();
 
 	/**
 	 * Display the graphics from the ground up; show the background, then all nodes, then the text_editor if it's active.
+	 * Does nothing if no layer was invalidated since the last frame.
 	 */
 	void render();
 
+	/**
+	 * Mark layers as changed, so the next render() draws them again.
+	 *
+	 * \param layers: The RenderLayer flags of every layer that changed
+	 */
+	void invalidate(int layers) { dirty_layers |= layers; }
+
 	/**
 	 * \return the state of the program. False if the program was asked to complete.
 	 */
@@ -93,8 +120,10 @@ public:
 	 * \param x_pos: The x position this node will be created at
 	 * \param y_pos: The y position this node will be created at
 	 * \creating_new_node: True if a node is being created during runtime
+	 * \param type: The kind of node
+	 * \return The NodeId of the new node
 	 */
-	void addNodeToVector(std::string title = "new node", std::string file_name = "NONE", int x_pos=0, int y_pos=0, bool creating_new_node = false);
+	NodeId addNodeToVector(std::string title = "new node", std::string file_name = "NONE", int x_pos=0, int y_pos=0, bool creating_new_node = false, NodeType type = NODE_TYPE_NOTE);
 	
 	/**
 	 * Prompt the user to create a new node. This is used when generating a file, so the user will
@@ -106,13 +135,13 @@ public:
 	void createNode(int x_pos=0, int y_pos=0);
 	
 	/**
-	 * Add a new Node to the vector of nodes stored by GraphManager.
+	 * Find the Node under the mouse. If Nodes overlap, the one drawn on top is found.
 	 *
 	 * \param mousex: the x position of the mouse
 	 * \param mousey: the y position of the mouse
-	 * \return the Node underneath the mouse. Returns nullptr if no such Node exists.
+	 * \return the Node underneath the mouse. Returns NO_NODE if no such Node exists.
 	 */
-	Node* detectNodeUnderMouse(int mousex, int mousey);
+	NodeId detectNodeUnderMouse(int mousex, int mousey);
 
 	/**
 	 * Ask the user if they would like to delete the target Node, and if yes then delete it.
@@ -129,22 +158,87 @@ public:
 	void closeGraph();
 	int promptGraphSelection(std::string message);
 	std::string ensureUniqueNodeName(std::string node_name, std::string message);
-	std::unordered_map<std::string, std::string> loadMetadataFromNBG();
 
-	//TBD - unimplemented features
-	//void connectNodes();
+	/**
+	 * Connect two nodes, or disconnect them if they're already connected.
+	 *
+	 * \param a: One of the nodes
+	 * \param b: The other node
+	 */
+	void connectNodes(NodeId a, NodeId b);
 
 private:
 	/**
-	 * Mark the Node "target" as not selected, set target to nullptr, and close the text editor.
+	 * \return The NodeId of the target node, or NO_NODE if there isn't one. A handle to a removed node is never used.
+	 */
+	NodeId getTarget() const { return nodes.resolve(target); }
+
+	/**
+	 * \return The NodeId of the node under the mouse, or NO_NODE if there isn't one.
+	 */
+	NodeId getHoverTarget() const { return nodes.resolve(hover_target); }
+
+	/**
+	 * Mark the Node "target" as not selected, set target to NO_HANDLE, and close the text editor.
 	 */
 	void deselectTargetNode();
 
 	/**
 	 * Select a different Node to be the "target", and open the text editor for that Node.
-	 * \param new_target: A Node pointer to replace "target"
+	 * \param new_target: The NodeId to replace "target"
+	 */
+	void openTargetNode(NodeId new_target);
+
+	/**
+	 * Add the nodes the GraphLoader has read so far to the graph. Once it's finished, connect the nodes and delete it.
+	 *
+	 * \param wait: If true, wait for the whole graph to be read, so it's completely loaded when this returns
+	 */
+	void takeLoadedNodes(bool wait = false);
+
+	/**
+	 * Give the journal a snapshot of the whole graph, to be saved as the nbg file in the background. Used once the
+	 * journal has grown large, so the next load has less to replay.
+	 */
+	void compactGraph();
+
+	/**
+	 * Move the open graph's notes into one container file, or out of it into a file for each note, whichever they
+	 * aren't in now.
+	 */
+	void convertStorage();
+
+	/**
+	 * Draw a bar at the bottom of the window showing how much of the graph has been loaded.
+	 */
+	void renderLoadProgress();
+
+	/**
+	 * Draw the background and the nodes (or clusters) the camera can see, onto the current render target.
+	 */
+	void renderGraph();
+
+	/**
+	 * Draw a block for each cluster of nodes the camera can see, with the number of nodes in it. Used instead of
+	 * drawing the nodes when zoomed out past CLUSTER_ZOOM_THRESHOLD.
+	 *
+	 * \param view: The area of the graph to draw, in world coordinates
 	 */
-	void openTargetNode(Node* new_target);
+	void renderClusters(const SDL_Rect& view);
+
+	/**
+	 * Handle a single event, sending it to the camera, the text editor, or the graph.
+	 *
+	 * \param event: The SDL_Event* describing a user input to the program
+	 */
+	void handleEvent(SDL_Event* event);
+
+	/**
+	 * If event is a mouse movement, merge every mouse movement right after it in the queue into it.
+	 *
+	 * \param event: The SDL_Event* to merge into. It's replaced by the latest movement, with the movement added up
+	 */
+	void coalesceMouseMotion(SDL_Event* event);
 
 	/**
 	 * Handle events specific to the Text Editor (as opposed to the graph).
@@ -154,6 +248,14 @@ private:
 	 */
 	bool handleTextEditorEvent(SDL_Event* event);
 
+	/**
+	 * Pan or zoom the camera, using the right mouse button and the mouse wheel.
+	 *
+	 * \param event: The SDL_Event* describing a user input to the program
+	 * \return true if the event moved the camera
+	 */
+	bool handleCameraEvent(SDL_Event* event);
+
 	/**
 	 * Handle events specific to the Graph (as opposed to the text editor).
 	 * \param event: The SDL_Event* describing a user input to the program
@@ -184,16 +286,80 @@ private:
 	//Indicates whether the program is fullscreen or not
 	bool fullscreen = false;
 
-	//The current target node, i.e. a node that was clicked with the left mouse button. If nullptr, there is no target node
-	Node* target = nullptr;
+	//The current target node, i.e. a node that was clicked with the left mouse button. Use getTarget() to find it
+	NodeHandle target = NO_HANDLE;
 
-	//The current node being hovered over. If nullptr, there is not a node under the mouse
-	Node* hover_target = nullptr;
+	//The current node being hovered over. Use getHoverTarget() to find it
+	NodeHandle hover_target = NO_HANDLE;
 
 	//A pointer to the text editor object used to display and edit Node contents
 	TextEditor* text_editor = nullptr;
 
-	//The vector of all Nodes displayed on this graph
-	std::vector<Node*> nodes;
+	//Every node displayed on this graph
+	NodeStore nodes;
+
+	//The connections between the nodes of this graph
+	ConnectionStore connections;
+
+	//An index of the nodes by position, for finding the node under the mouse without checking every node
+	SpatialGrid node_index;
+
+	//The nodes the camera could see in the last frame. Kept between frames so the memory is reused
+	std::vector<NodeId> visible_nodes;
+
+	//The neighbors of the last node opened, to be read ahead. Kept between calls so the memory is reused
+	std::vector<NodeId> neighbors;
+
+	//The clusters the camera could see in the last zoomed out frame, and their screen rectangles for each shade
+	std::vector<Cluster> visible_clusters;
+	std::vector<SDL_Rect> cluster_rects[CLUSTER_SHADE_COUNT];
+
+	//Reads the open graph in the background. Null unless a graph is still loading
+	GraphLoader* loader = nullptr;
+
+	//Saves each change to the open graph's nodes and connections as it's made. Null unless a graph is open
+	GraphJournal* journal = nullptr;
+
+	//Where the open graph's notes are kept, as files or packed into one. Null unless a graph is open
+	NoteStorage* storage = nullptr;
+
+	//The node made for each title while loading, so the connections can be found and no note is added twice
+	std::unordered_map<std::string, NodeId> loading_ids;
+
+	//The nodes taken from the loader. Kept between frames so the memory is reused
+	std::vector<LoadedNode> loaded_nodes;
+
+	//The progress last shown while loading, so the bar is only drawn again when it changes
+	int load_found = 0;
+	bool load_scanned = false;
+
+	//The time, from SDL_GetTicks(), the graph started loading
+	Uint32 load_start_time = 0;
+
+	//The view of the graph, which converts node positions to the screen
+	Camera camera;
+
+	//Collects the visible nodes each frame, so they're drawn a group at a time instead of one at a time
+	NodeBatch node_batch;
+
+	//Indicates that the graph is being dragged with the right mouse button
+	bool panning = false;
+
+	//Indicates that the target was dragged with the left mouse button, and the move isn't journaled until it's released
+	bool dragging_target = false;
+
+	//The RenderLayer flags of the layers changed since the last frame. If 0 (and the editor is unchanged), render()
+	//has nothing to do
+	int dirty_layers = LAYER_ALL;
+
+	//The graph as it was last drawn, copied to the window each frame. Null if the renderer can't draw to textures, in
+	//which case the graph is drawn to the window directly every frame
+	SDL_Texture* graph_layer = nullptr;
+
+	//The fewest milliseconds between frames, when the renderer can't wait for the display to refresh. 0 with vsync
+	int frame_interval_ms = 0;
+
+	//The time, from SDL_GetTicks(), the last frame was presented
+	Uint32 last_frame_time = 0;
 
 };
\ No newline at end of file
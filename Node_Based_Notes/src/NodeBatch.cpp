@@ -0,0 +1,20 @@
+//Author: Connor Kamrowski. See header file for more information.
+#include "NodeBatch.h"
+
+//Draw each group in its color, and empty the batch for the next frame.
+void NodeBatch::flush(SDL_Renderer* renderer) {
+	//The color of each group, in the order of NodeState
+	const SDL_Color* colors[NODE_STATE_COUNT] = { &NODE_BASE_COLOR, &NODE_HOVER_COLOR, &NODE_SELECTED_COLOR };
+
+	for (int state = 0; state < NODE_STATE_COUNT; state++) {
+		if (rects[state].empty()) {
+			continue;
+		}
+
+		CustomSDL_setRenderDrawColor(renderer, colors[state]);
+		SDL_RenderFillRects(renderer, rects[state].data(), (int)rects[state].size());
+
+		//clear the group, but keep the memory so the next frame doesn't have to allocate it again
+		rects[state].clear();
+	}
+}
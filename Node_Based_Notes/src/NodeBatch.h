@@ -0,0 +1,43 @@
+/*
+ * NodeBatch collects the rectangles of every node drawn in a frame, grouped by how the node looks (base, hovered or
+ * selected). Each group is drawn with one color change and one SDL_RenderFillRects call, instead of two renderer
+ * calls for every node.
+ *
+ * Groups are drawn in order, base first, so hovered and selected nodes always appear on top of the others.
+ *
+ * Author: Connor Kamrowski
+ */
+#pragma once
+#include "Config.h"
+#include "Utils.h"
+
+//The ways a node can look. Each has its own color in Config.h, and its own group in a NodeBatch
+enum NodeState {
+	NODE_STATE_BASE,
+	NODE_STATE_HOVERED,
+	NODE_STATE_SELECTED,
+	NODE_STATE_COUNT
+};
+
+class NodeBatch {
+public:
+	/**
+	 * Add a node's rectangle to its group. Nothing is displayed until flush() is called.
+	 *
+	 * \param state: How the node looks, which decides its color
+	 * \param rect: The rectangle to fill, in screen coordinates
+	 */
+	void queue(NodeState state, const SDL_Rect& rect) { rects[state].push_back(rect); }
+
+	/**
+	 * Draw every queued rectangle, one SDL_RenderFillRects call per group, then empty the batch.
+	 *
+	 * \param renderer: The SDL_Renderer* being used
+	 */
+	void flush(SDL_Renderer* renderer);
+
+private:
+	//The rectangles waiting to be drawn, for each NodeState
+	std::vector<SDL_Rect> rects[NODE_STATE_COUNT];
+
+};
@@ -0,0 +1,190 @@
+//Author: Connor Kamrowski. See header file for more information.
+#include "NodeStore.h"
+#include "SpatialGrid.h"
+
+/**
+ * Add a node, given a title, filename, and x,y coordinates. A free slot is used if there is one, otherwise every
+ * array grows by one.
+ */
+NodeId NodeStore::add(const std::string& title, const std::string& file_name, int x_pos, int y_pos, NodeType type) {
+	NodeId id;
+
+	if (!free_slots.empty()) {
+		id = free_slots.back();
+		free_slots.pop_back();
+	}
+	else {
+		id = (int)flags.size();
+
+		pos_x.push_back(0);
+		pos_y.push_back(0);
+		width.push_back(0);
+		height.push_back(0);
+		flags.push_back(0);
+		types.push_back(0);
+		text.push_back(NodeText());
+		generations.push_back(next_generation);
+	}
+
+	//The position is the center of the node
+	pos_x[id] = x_pos - NODE_WIDTH / 2;
+	pos_y[id] = y_pos - NODE_WIDTH / 2;
+	width[id] = NODE_WIDTH;
+	height[id] = NODE_WIDTH;
+	flags[id] = NODE_FLAG_USED;
+	types[id] = (Uint8)type;
+	text[id].title = addText(title);
+	text[id].fname = addText(file_name);
+
+	count++;
+	return id;
+
+}//END OF add()
+
+//Mark the slot as unused, and make every handle to it stale.
+void NodeStore::remove(NodeId id) {
+	if (!contains(id)) {
+		return;
+	}
+
+	flags[id] = 0;
+	generations[id]++;
+
+	removeText(text[id].title);
+	removeText(text[id].fname);
+	text[id] = NodeText();
+	packText();
+
+	free_slots.push_back(id);
+	count--;
+}
+
+/**
+ * Swap every array with an empty one, so their memory is freed and not just emptied. The next generation is past
+ * every generation used so far, so old handles stay stale even though the slots will be used again.
+ */
+void NodeStore::clear() {
+	std::vector<int>().swap(pos_x);
+	std::vector<int>().swap(pos_y);
+	std::vector<int>().swap(width);
+	std::vector<int>().swap(height);
+	std::vector<Uint8>().swap(flags);
+	std::vector<Uint8>().swap(types);
+	std::vector<NodeText>().swap(text);
+	std::vector<NodeId>().swap(free_slots);
+
+	for (unsigned int generation : generations) {
+		next_generation = std::max(next_generation, generation);
+	}
+	next_generation++;
+	std::vector<unsigned int>().swap(generations);
+
+	std::string().swap(characters);
+	unused_characters = 0;
+
+	count = 0;
+}
+
+/**
+ * Given the NodeBatch*, queue the node to be rendered. This changes based on the status of the node.
+ */
+void NodeStore::render(NodeId id, NodeBatch* batch, const Camera& camera) const {
+	//Choose the group to draw in, which decides the color, based on the status
+	NodeState state = NODE_STATE_BASE;
+	if (flags[id] & NODE_FLAG_SELECTED) {
+		state = NODE_STATE_SELECTED;
+	}
+	else if (flags[id] & NODE_FLAG_HOVERED) {
+		state = NODE_STATE_HOVERED;
+	}
+
+	//If the node is selected or hovered, increase the size by a constant
+	int diff = 0;
+	if (state != NODE_STATE_BASE) {
+		diff = NODE_SIZE_INCREASE;
+	}
+
+	//Queue the rectangle, where the camera shows it
+	SDL_Rect grown = { pos_x[id] - diff, pos_y[id] - diff, width[id] + diff * 2, height[id] + diff * 2 };
+	batch->queue(state, camera.worldToScreen(grown));
+
+}//END OF render()
+
+/**
+ * A simple setter function; change the x,y coordinates of the node to be the x,y parameters.
+ * The x,y position is relative to the center of the node, NOT the top-left corner.
+ */
+void NodeStore::setPos(NodeId id, int x, int y) {
+	pos_x[id] = x - width[id] / 2;
+	pos_y[id] = y - height[id] / 2;
+
+	//Move the node to its new cells, so it can be found at its new position
+	if (index != nullptr) {
+		index->update(id, getShape(id));
+	}
+}
+
+/**
+ * A complicated setter function.
+ * Change the title of the node, as well as the file path associated with the node.
+ */
+void NodeStore::setTitle(NodeId id, const std::string& new_title) {
+	std::string title = getTitle(id);
+	std::string fname = getFName(id);
+
+	//get the index of the title in 'fname' string
+	int start = fname.find(title);
+	int end = start + title.length();
+
+	//change the file path to reflect the new title
+	fname.replace(start, end, new_title);
+
+	fname += ".txt";
+
+	//change the title, leaving the old strings to be packed away
+	removeText(text[id].title);
+	removeText(text[id].fname);
+	text[id].title = addText(new_title);
+	text[id].fname = addText(fname);
+	packText();
+
+}
+
+//Append the string, and remember where it starts.
+NodeStore::TextRange NodeStore::addText(const std::string& value) {
+	TextRange range;
+	range.start = (int)characters.length();
+	range.length = (int)value.length();
+
+	characters += value;
+	return range;
+}
+
+/**
+ * Copy the strings of every node into a new block, in slot order. This only happens once more than half of the block
+ * is unused, so the cost is spread over the removes and renames that left it behind.
+ */
+void NodeStore::packText() {
+	if (unused_characters * 2 <= (int)characters.length()) {
+		return;
+	}
+
+	std::string packed;
+	packed.reserve(characters.length() - unused_characters);
+
+	for (NodeId id = 0; id < (int)text.size(); id++) {
+		if (!contains(id)) {
+			continue;
+		}
+
+		for (TextRange* range : { &text[id].title, &text[id].fname }) {
+			int start = (int)packed.length();
+			packed.append(characters, range->start, range->length);
+			range->start = start;
+		}
+	}
+
+	characters.swap(packed);
+	unused_characters = 0;
+
+}//END OF packText()
@@ -0,0 +1,277 @@
+/*
+ * NodeStore holds every node in a graph. Each node represents a text file in the Graph's directory.
+ *
+ * Instead of a separate object for each node, the store keeps each property in its own array, indexed by the node's
+ * NodeId. Everything read while drawing and finding nodes (position, size, flags and type) is in small arrays next to
+ * each other, so looping over many nodes reads memory in order. The title and file path are only needed when a node
+ * is opened, renamed or saved, so they're kept apart in a separate table.
+ *
+ * A deleted node's slot is reused by the next node added, so a NodeId stays the same for as long as its node exists.
+ * Anything that keeps a node for longer than one event (like the selected node) holds a NodeHandle instead, which
+ * also remembers the generation of the slot. Each slot's generation changes when its node is removed, so a handle
+ * to a deleted node, or to a node of a graph that was closed, is found to be stale instead of being used.
+ *
+ * The titles and file paths of every node are kept in one block of characters, so the whole graph is stored in a
+ * handful of arrays, and closing it frees them all at once.
+ *
+ * Author: Connor Kamrowski
+ */
+#pragma once
+#include "Config.h"
+#include "Utils.h"
+#include "Camera.h"
+#include "NodeBatch.h"
+
+class SpatialGrid;
+
+//The index of a node's slot in a NodeStore
+typedef int NodeId;
+
+//A NodeId that doesn't refer to any node
+const NodeId NO_NODE = -1;
+
+//A reference to a node that can be checked before it's used. It's stale once the node is removed
+struct NodeHandle {
+	//The slot of the node
+	NodeId id = NO_NODE;
+
+	//The generation of the slot when the handle was made
+	unsigned int generation = 0;
+
+	bool operator==(const NodeHandle& other) const { return id == other.id && generation == other.generation; }
+	bool operator!=(const NodeHandle& other) const { return !(*this == other); }
+};
+
+//A NodeHandle that doesn't refer to any node
+const NodeHandle NO_HANDLE = NodeHandle();
+
+//The flags kept for each node
+enum NodeFlag {
+	NODE_FLAG_USED = 1,
+	NODE_FLAG_HOVERED = 2,
+	NODE_FLAG_SELECTED = 4
+};
+
+//The kinds of node. Every node is a note for now
+enum NodeType {
+	NODE_TYPE_NOTE = 0,
+
+	//The number of kinds of node. Not a kind itself
+	NODE_TYPE_COUNT
+};
+
+class NodeStore {
+public:
+	/**
+	 * Add a node to the store, reusing the slot of a deleted node if there is one.
+	 *
+	 * \param title: The title of the node
+	 * \param file_name: The local path to the node's file
+	 * \param x_pos: The x position of the center of the node
+	 * \param y_pos: The y position of the center of the node
+	 * \param type: The kind of node
+	 * \return The NodeId of the new node
+	 */
+	NodeId add(const std::string& title, const std::string& file_name, int x_pos, int y_pos, NodeType type = NODE_TYPE_NOTE);
+
+	/**
+	 * Remove a node from the store. Its slot is kept to be reused by the next node added.
+	 *
+	 * \param id: The node to remove
+	 */
+	void remove(NodeId id);
+
+	/**
+	 * Remove every node, and free all of the memory used by them. Every handle to them becomes stale.
+	 */
+	void clear();
+
+	/**
+	 * \return The number of nodes in the store.
+	 */
+	int size() const { return count; }
+
+	/**
+	 * \return The number of slots in the store. Every NodeId is less than this, but some slots may be unused.
+	 */
+	int getSlotCount() const { return (int)flags.size(); }
+
+	/**
+	 * \return True if id refers to a node in the store.
+	 */
+	bool contains(NodeId id) const { return id >= 0 && id < (int)flags.size() && (flags[id] & NODE_FLAG_USED); }
+
+	/**
+	 * \return A handle to a node in the store.
+	 */
+	NodeHandle getHandle(NodeId id) const { return { id, generations[id] }; }
+
+	/**
+	 * \return True if the handle refers to a node that still exists.
+	 */
+	bool isValid(NodeHandle handle) const { return contains(handle.id) && generations[handle.id] == handle.generation; }
+
+	/**
+	 * \return The NodeId the handle refers to, or NO_NODE if the handle is stale.
+	 */
+	NodeId resolve(NodeHandle handle) const { return isValid(handle) ? handle.id : NO_NODE; }
+
+	/**
+	 * Queue a node in a batch of nodes to be drawn, displaying any variation in size and color based on hover/select
+	 * status. The node is displayed when the batch is flushed.
+	 *
+	 * \param id: The node to draw
+	 * \param batch: The NodeBatch* collecting this frame's nodes
+	 * \param camera: The Camera used to convert the node's position in the graph to the screen
+	 */
+	void render(NodeId id, NodeBatch* batch, const Camera& camera) const;
+
+	/*** Getter Functions ***/
+
+	/**
+	 * \return The x,y location and width,height of a node, in the graph's world coordinates.
+	 */
+	SDL_Rect getShape(NodeId id) const { return { pos_x[id], pos_y[id], width[id], height[id] }; }
+
+	/**
+	 * \return The title of a node.
+	 */
+	std::string getTitle(NodeId id) const { return getText(text[id].title); }
+
+	/**
+	 * \return The filename of a node.
+	 */
+	std::string getFName(NodeId id) const { return getText(text[id].fname); }
+
+	/**
+	 * \return The kind of node.
+	 */
+	NodeType getType(NodeId id) const { return (NodeType)types[id]; }
+
+	/**
+	 * \return The node's select status. True if the left mouse button was clicked on this node.
+	 */
+	bool getSelectStatus(NodeId id) const { return (flags[id] & NODE_FLAG_SELECTED) != 0; }
+
+	/**
+	 * \return The node's hover status. True if mouse is hovering over this node.
+	 */
+	bool getHoverStatus(NodeId id) const { return (flags[id] & NODE_FLAG_HOVERED) != 0; }
+
+	/*** Setter Functions ***/
+
+	/**
+	 * Update the hover status of a node. If true, the mouse is hovering over the node.
+	 */
+	void updateHoverStatus(NodeId id, bool new_status) { setFlag(id, NODE_FLAG_HOVERED, new_status); }
+
+	/**
+	 * Update the selected status of a node.
+	 */
+	void updateSelectStatus(NodeId id, bool new_status) { setFlag(id, NODE_FLAG_SELECTED, new_status); }
+
+	/**
+	 * Regardless of the node's state, clear its selected and hovered flags.
+	 */
+	void deselect(NodeId id) { flags[id] &= ~(NODE_FLAG_SELECTED | NODE_FLAG_HOVERED); }
+
+	/**
+	 * Set the x,y position of the center of a node. If the store has a SpatialGrid, the grid is updated.
+	 * \param x: The new x position.
+	 * \param y: The new y position.
+	 */
+	void setPos(NodeId id, int x, int y);
+
+	/**
+	 * Rename a node (change the title), and change its file path to match. The note itself is moved by the caller.
+	 * \param new_title: The new title for the node.
+	 */
+	void setTitle(NodeId id, const std::string& new_title);
+
+	/**
+	 * Set the SpatialGrid kept up to date when nodes move.
+	 * \param grid: The grid holding this store's nodes, or nullptr if there isn't one.
+	 */
+	void setIndex(SpatialGrid* grid) { index = grid; }
+
+private:
+	//A string kept in 'characters'
+	struct TextRange {
+		int start = 0;
+		int length = 0;
+	};
+
+	//The parts of a node that are only used when it's opened, renamed or saved
+	struct NodeText {
+		//The title of the node
+		TextRange title;
+
+		//The local path to the node's file
+		TextRange fname;
+	};
+
+	/**
+	 * Set or clear one of a node's flags.
+	 */
+	void setFlag(NodeId id, NodeFlag flag, bool value) { flags[id] = value ? (flags[id] | flag) : (flags[id] & ~flag); }
+
+	/**
+	 * \return A copy of a string kept in 'characters'.
+	 */
+	std::string getText(TextRange range) const { return characters.substr(range.start, range.length); }
+
+	/**
+	 * Add a string to the end of 'characters'.
+	 *
+	 * \return Where the string was put
+	 */
+	TextRange addText(const std::string& value);
+
+	/**
+	 * Forget a string in 'characters'. Its space is reclaimed the next time the characters are packed.
+	 */
+	void removeText(TextRange range) { unused_characters += range.length; }
+
+	/**
+	 * If most of 'characters' is no longer used by any node, copy the strings still in use into a new block.
+	 */
+	void packText();
+
+	//The x,y of the top-left corner, and width, height of each node
+	std::vector<int> pos_x;
+	std::vector<int> pos_y;
+	std::vector<int> width;
+	std::vector<int> height;
+
+	//The NodeFlags of each node. Unused slots have no flags at all
+	std::vector<Uint8> flags;
+
+	//The NodeType of each node
+	std::vector<Uint8> types;
+
+	//The title and file path of each node
+	std::vector<NodeText> text;
+
+	//The generation of each slot. It changes whenever the slot's node is removed, making every handle to it stale
+	std::vector<unsigned int> generations;
+
+	//The generation given to new slots. After clear(), it's higher than any generation used before, so handles to
+	//the old nodes can't match the new ones
+	unsigned int next_generation = 0;
+
+	//The titles and file paths of every node, one after another
+	std::string characters;
+
+	//The number of characters in 'characters' left behind by removed or renamed nodes
+	int unused_characters = 0;
+
+	//The slots of deleted nodes, to be reused
+	std::vector<NodeId> free_slots;
+
+	//The number of nodes in the store
+	int count = 0;
+
+	//The grid used to find nodes by position. Updated whenever a node moves
+	SpatialGrid* index = nullptr;
+
+};
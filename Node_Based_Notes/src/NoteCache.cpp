@@ -0,0 +1,164 @@
+//Author: Connor Kamrowski. See header file for more information.
+#include "NoteCache.h"
+
+/**
+ * The NoteCache constructor. The thread is started last, once everything it uses is ready.
+ */
+NoteCache::NoteCache(AutosaveWorker* saves) {
+	this->saves = saves;
+	worker = std::thread(&NoteCache::run, this);
+}
+
+/**
+ * The NoteCache deconstructor. Unlike saves, prefetches don't need to finish, so the thread stops after the read it's
+ * doing now.
+ */
+NoteCache::~NoteCache() {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+		pending.clear();
+	}
+	changed.notify_all();
+
+	worker.join();
+}
+
+/**
+ * Queue the path at the front, so the node the mouse is over now is read before ones it passed over earlier. A note
+ * already in the cache is only marked as recently used.
+ */
+void NoteCache::prefetch(const std::string& path) {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+
+		auto found = lookup.find(path);
+		if (found != lookup.end()) {
+			entries.splice(entries.begin(), entries, found->second);
+			return;
+		}
+
+		if (reading_path == path) {
+			return;
+		}
+
+		//move the path to the front if it's already waiting
+		auto waiting = std::find(pending.begin(), pending.end(), path);
+		if (waiting != pending.end()) {
+			pending.erase(waiting);
+		}
+
+		pending.push_front(path);
+		if ((int)pending.size() > NOTE_PREFETCH_QUEUE_SIZE) {
+			pending.pop_back();
+		}
+	}
+	changed.notify_all();
+}
+
+/**
+ * Find the note in the cache, waiting if it's being read. A note that isn't in the cache is taken out of 'pending', as
+ * the caller reads it instead.
+ */
+std::shared_ptr<const std::string> NoteCache::get(const std::string& path) {
+	std::unique_lock<std::mutex> guard(lock);
+	changed.wait(guard, [&] { return reading_path != path; });
+
+	auto found = lookup.find(path);
+	if (found == lookup.end()) {
+		misses++;
+
+		auto waiting = std::find(pending.begin(), pending.end(), path);
+		if (waiting != pending.end()) {
+			pending.erase(waiting);
+		}
+
+		return nullptr;
+	}
+
+	hits++;
+
+	//move the entry to the front, it was just used
+	entries.splice(entries.begin(), entries, found->second);
+	return found->second->text;
+}
+
+//Remove the note from the cache, and mark a read of it as stale.
+void NoteCache::invalidate(const std::string& path) {
+	std::lock_guard<std::mutex> guard(lock);
+
+	auto found = lookup.find(path);
+	if (found != lookup.end()) {
+		bytes_used -= found->second->text->length();
+		entries.erase(found->second);
+		lookup.erase(found);
+	}
+
+	if (reading_path == path) {
+		reading_stale = true;
+	}
+}
+
+//Drop everything, and wait for a read from the old storage to finish, so it's never used after it's deleted.
+void NoteCache::setStorage(NoteStorage* storage) {
+	std::unique_lock<std::mutex> guard(lock);
+	pending.clear();
+	changed.wait(guard, [&] { return reading_path.empty(); });
+
+	entries.clear();
+	lookup.clear();
+	bytes_used = 0;
+	this->storage = storage;
+}
+
+/**
+ * Read notes until stopped. The lock isn't held while reading, so prefetches can keep being queued, and any save of
+ * the note is waited for first, so the newest text is read.
+ */
+void NoteCache::run() {
+	std::unique_lock<std::mutex> guard(lock);
+
+	while (true) {
+		changed.wait(guard, [&] { return !pending.empty() || stopping; });
+
+		if (stopping) {
+			return;
+		}
+
+		//take the next path
+		std::string path = pending.front();
+		pending.pop_front();
+		reading_path = path;
+		reading_stale = false;
+		NoteStorage* source = storage;
+
+		//read the note without holding the lock
+		guard.unlock();
+		saves->wait(path);
+		std::string text;
+		bool read = source != nullptr && source->read(path, text);
+		guard.lock();
+
+		//A note bigger than the whole budget isn't kept. It's read again when it's opened
+		if (read && !reading_stale && !stopping && text.length() <= NOTE_CACHE_BUDGET) {
+			bytes_used += text.length();
+			entries.push_front({ path, std::make_shared<const std::string>(std::move(text)) });
+			lookup[path] = entries.begin();
+			evict();
+		}
+
+		reading_path.clear();
+		changed.notify_all();
+	}
+
+}//END OF run()
+
+//Drop the least recently used notes, found at the back of the list, until the cache fits in the budget.
+void NoteCache::evict() {
+	while (bytes_used > NOTE_CACHE_BUDGET) {
+		Entry& entry = entries.back();
+		bytes_used -= entry.text->length();
+		lookup.erase(entry.path);
+		entries.pop_back();
+	}
+}
@@ -0,0 +1,134 @@
+/*
+ * NoteCache reads notes before they're opened, so clicking a node doesn't wait on the disk. GraphManager asks for a
+ * note to be prefetched when the mouse moves over its node, and for the neighbors of a note when it's opened, since
+ * those are the notes most likely to be opened next. A background thread reads them, newest request first.
+ *
+ * The text of each note read is kept until the cache is over its byte budget, when the least recently used notes are
+ * dropped. A note is dropped from the cache as soon as a save of it is queued, and a note is never read while a save
+ * of it is waiting, so the cache never holds older text than the file.
+ *
+ * Author: Connor Kamrowski
+ */
+#pragma once
+#include "Config.h"
+#include "NoteStorage.h"
+#include "AutosaveWorker.h"
+
+#include <list>
+#include <deque>
+#include <unordered_map>
+
+class NoteCache {
+public:
+	/**
+	 * NoteCache constructor. Starts the reading thread, which sleeps until a note is prefetched.
+	 *
+	 * \param saves: The AutosaveWorker saving the notes, so a note isn't read while a save of it is waiting
+	 */
+	NoteCache(AutosaveWorker* saves);
+
+	/**
+	 * NoteCache deconstructor. Drops every prefetch waiting, then stops the reading thread.
+	 */
+	~NoteCache();
+
+	/**
+	 * Read a note in the background, if it isn't already in the cache. It's read before any prefetch asked for
+	 * earlier. If too many are waiting, the oldest request is dropped.
+	 *
+	 * \param path: The path of the note's file
+	 */
+	void prefetch(const std::string& path);
+
+	/**
+	 * Get a note's text from the cache. If the note is being read right now, wait for it.
+	 *
+	 * \param path: The path of the note's file
+	 * \return The text of the note, or nullptr if it isn't in the cache and has to be read
+	 */
+	std::shared_ptr<const std::string> get(const std::string& path);
+
+	/**
+	 * Drop a note from the cache, and throw away a read of it that's already started. Called when the note's file
+	 * is saved, renamed or deleted.
+	 *
+	 * \param path: The path of the note's file
+	 */
+	void invalidate(const std::string& path);
+
+	/**
+	 * Change the storage notes are read from. Everything in the cache, and every prefetch waiting, is dropped, as it
+	 * came from the old storage.
+	 *
+	 * \param storage: The storage to read from. Null when no graph is open
+	 */
+	void setStorage(NoteStorage* storage);
+
+	/**
+	 * \return The number of times a note was found in the cache.
+	 */
+	int getHits() { return hits; }
+
+	/**
+	 * \return The number of times a note had to be read when it was opened.
+	 */
+	int getMisses() { return misses; }
+
+private:
+	//The text of a note in the cache
+	struct Entry {
+		std::string path;
+		std::shared_ptr<const std::string> text;
+	};
+
+	/**
+	 * The reading thread. Takes paths off of 'pending' and reads them, one at a time, until the cache is stopped.
+	 */
+	void run();
+
+	/**
+	 * Drop the least recently used notes until the cache is within NOTE_CACHE_BUDGET. The caller must hold the lock.
+	 */
+	void evict();
+
+	//Every note in the cache, with the most recently used at the front
+	std::list<Entry> entries;
+
+	//The location of each note in 'entries', by path
+	std::unordered_map<std::string, std::list<Entry>::iterator> lookup;
+
+	//The number of bytes of text held by the cache
+	size_t bytes_used = 0;
+
+	//The paths waiting to be read, with the next to read at the front
+	std::deque<std::string> pending;
+
+	//The path of the note being read right now. Empty if the thread is waiting
+	std::string reading_path;
+
+	//Indicates that the note being read was saved since the read started, so the text read can't be kept
+	bool reading_stale = false;
+
+	//Indicates that the thread should stop
+	bool stopping = false;
+
+	//The number of cache hits and misses
+	int hits = 0;
+	int misses = 0;
+
+	//The worker saving the notes
+	AutosaveWorker* saves;
+
+	//The storage notes are read from
+	NoteStorage* storage = nullptr;
+
+	//Guards everything above that's shared with the reading thread
+	std::mutex lock;
+
+	//Wakes the thread when a note is prefetched, and wakes get() when a read finishes
+	std::condition_variable changed;
+
+	//The thread that does the reading
+	std::thread worker;
+
+};
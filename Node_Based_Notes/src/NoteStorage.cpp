@@ -0,0 +1,41 @@
+//Author: Connor Kamrowski. See header file for more information.
+#include "NoteStorage.h"
+#include "DirectoryStorage.h"
+#include "PackedStorage.h"
+
+#include <filesystem>
+
+//A graph is packed if its directory has a container in it.
+NoteStorage* NoteStorage::open(const std::string& graph_path) {
+	std::error_code error;
+	if (std::filesystem::exists(graph_path + PACKED_NOTES_PATH, error)) {
+		return new PackedStorage(graph_path);
+	}
+
+	return new DirectoryStorage(graph_path);
+}
+
+/**
+ * List the titles first, then copy the notes one at a time, so only one note's text is in memory at once. Every note
+ * is tried, even after one fails.
+ */
+bool NoteStorage::copyNotes(NoteStorage& from, NoteStorage& to, const std::string& graph_path) {
+	std::vector<std::string> titles;
+	if (!from.list([&](std::string&& title) { titles.push_back(std::move(title)); return true; })) {
+		return false;
+	}
+
+	bool copied = true;
+	std::string text;
+	for (const std::string& title : titles) {
+		std::string path = graph_path + title + ".txt";
+
+		if (!from.read(path, text) || !to.write(path, StringSnapshot(std::move(text)))) {
+			std::cout << "ERROR: The note could not be copied. Title: " << title << std::endl;
+			copied = false;
+		}
+	}
+
+	return copied;
+
+}//END OF copyNotes()
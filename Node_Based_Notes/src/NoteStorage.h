@@ -0,0 +1,104 @@
+/*
+ * NoteStorage is where the text of a graph's notes is kept. Everything that reads or writes a note goes through it, so
+ * the notes can be kept in different ways without the rest of the program knowing:
+ *	* DirectoryStorage keeps each note in its own .txt file in the graph's directory. This is the default
+ *	* PackedStorage keeps every note in one container file, which is much faster for very large graphs
+ *
+ * A note is always named by the path its .txt file has in the directory layout (the graph's directory, the title,
+ * then ".txt"), whichever storage is used, so node file names and saves don't change when the storage does.
+ *
+ * A storage may be used by several threads at once: the UI thread, the AutosaveWorker, the NoteCache and the
+ * GraphLoader.
+ *
+ * Author: Connor Kamrowski
+ */
+#pragma once
+#include "Config.h"
+#include "TextDocument.h"
+
+#include <functional>
+
+class NoteStorage {
+public:
+	/**
+	 * NoteStorage deconstructor. Finishes anything the storage needs to save.
+	 */
+	virtual ~NoteStorage() {}
+
+	/**
+	 * Open the storage a graph uses. A graph with a packed container uses PackedStorage, any other uses
+	 * DirectoryStorage.
+	 *
+	 * \param graph_path: The path of the graph's directory, ending in '/'
+	 * \return The new storage, which the caller deletes
+	 */
+	static NoteStorage* open(const std::string& graph_path);
+
+	/**
+	 * Copy every note from one storage to another. Used to pack a graph into a container, or to unpack it.
+	 *
+	 * \param from: The storage to copy the notes from
+	 * \param to: The storage to copy the notes into
+	 * \param graph_path: The path of the graph's directory, ending in '/'
+	 * \return false if any note couldn't be copied
+	 */
+	static bool copyNotes(NoteStorage& from, NoteStorage& to, const std::string& graph_path);
+
+	/**
+	 * Read the whole text of a note.
+	 *
+	 * \param path: The path of the note
+	 * \param out: The string the note is read into. Its previous contents are replaced
+	 * \return false if the note couldn't be read
+	 */
+	virtual bool read(const std::string& path, std::string& out) = 0;
+
+	/**
+	 * Save the text of a note, creating it if it doesn't exist. If the save fails partway, the old text is kept.
+	 *
+	 * \param path: The path of the note
+	 * \param text: The text to save
+	 * \return false if the note couldn't be saved
+	 */
+	virtual bool write(const std::string& path, const TextSnapshot& text) = 0;
+
+	/**
+	 * \return true if there is a note at path.
+	 */
+	virtual bool exists(const std::string& path) = 0;
+
+	/**
+	 * Delete a note.
+	 *
+	 * \return false if the note couldn't be deleted
+	 */
+	virtual bool remove(const std::string& path) = 0;
+
+	/**
+	 * Move a note to a new path, when its node is renamed.
+	 *
+	 * \return false if the note couldn't be moved
+	 */
+	virtual bool rename(const std::string& old_path, const std::string& new_path) = 0;
+
+	/**
+	 * Find the title of every note.
+	 *
+	 * \param found: Called with each title. Listing stops early if it returns false
+	 * \return false if the notes couldn't be listed
+	 */
+	virtual bool list(const std::function<bool(std::string&&)>& found) = 0;
+
+	/**
+	 * Delete every note. Used once the notes have been copied to a different storage.
+	 *
+	 * \return false if any note couldn't be deleted
+	 */
+	virtual bool clear() = 0;
+
+	/**
+	 * \return true if the notes are packed into one container file.
+	 */
+	virtual bool isPacked() const = 0;
+
+};
@@ -0,0 +1,811 @@
+//Author: Connor Kamrowski. See header file for more information.
+#include "PackedStorage.h"
+#include "GraphFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+namespace fs = std::filesystem;
+
+//The container's header: the magic, the version and flags, the index's slot, the end of the slots, and the last
+//sequence number, then the checksum of everything before it
+const size_t FILE_VERSION_OFFSET = 4;
+const size_t FILE_FLAGS_OFFSET = 8;
+const size_t FILE_INDEX_POSITION_OFFSET = 16;
+const size_t FILE_DATA_END_OFFSET = 24;
+const size_t FILE_SEQUENCE_OFFSET = 32;
+const size_t FILE_CHECKSUM_OFFSET = 40;
+const size_t FILE_HEADER_LENGTH = 64;
+
+//A slot's header: its kind and title length, its size, sequence number and text length, then the checksum of
+//everything before it
+const size_t SLOT_KIND_OFFSET = 0;
+const size_t SLOT_TITLE_LENGTH_OFFSET = 4;
+const size_t SLOT_CAPACITY_OFFSET = 8;
+const size_t SLOT_SEQUENCE_OFFSET = 16;
+const size_t SLOT_TEXT_LENGTH_OFFSET = 24;
+const size_t SLOT_CHECKSUM_OFFSET = 32;
+const size_t SLOT_HEADER_LENGTH = 40;
+
+//The kinds of slot
+const Uint32 SLOT_FREE = 1;
+const Uint32 SLOT_NOTE = 2;
+const Uint32 SLOT_INDEX = 3;
+
+//The header flag set while the index is up to date
+const Uint32 FLAG_CLEAN = 1;
+
+//Round a size up to a whole number of PACKED_SLOT_ALIGN
+static Uint64 alignSlot(Uint64 size) {
+	return (size + PACKED_SLOT_ALIGN - 1) / PACKED_SLOT_ALIGN * PACKED_SLOT_ALIGN;
+}
+
+//Fill the rest of a slot after its text with zeros, so the file always reaches the end of its last slot
+static bool writePadding(FILE* target, Uint64 capacity, Uint64 used) {
+	static const char zeros[PACKED_SLOT_ALIGN] = {};
+	size_t padding = (size_t)(capacity - used);
+	return padding == 0 || fwrite(zeros, 1, padding, target) == padding;
+}
+
+/**
+ * The PackedStorage constructor. A new container is written with no notes and an empty index, so it's already closed
+ * properly.
+ */
+PackedStorage::PackedStorage(const std::string& graph_path, const std::string& container_name)
+	: graph_path(graph_path), container_path(graph_path + container_name) {
+
+	if (!fs::exists(container_path)) {
+		FILE* created = FileIO::openFile(container_path, "wb");
+		data_end = FILE_HEADER_LENGTH;
+		bool written = created != nullptr && writeFileHeader(created, true, 0) && FileIO::syncFile(created);
+		if (created != nullptr) {
+			fclose(created);
+		}
+
+		if (!written) {
+			std::cout << "ERROR: The notes container could not be created. Path: " << container_path << std::endl;
+			return;
+		}
+	}
+
+	file = FileIO::openFile(container_path, "r+b");
+	if (file == nullptr || !load()) {
+		std::cout << "ERROR: The notes container could not be opened. Path: " << container_path << std::endl;
+		if (file != nullptr) {
+			fclose(file);
+			file = nullptr;
+		}
+	}
+}
+
+/**
+ * The PackedStorage deconstructor. An unchanged container is left alone, as its index is already up to date.
+ */
+PackedStorage::~PackedStorage() {
+	std::lock_guard<std::mutex> guard(lock);
+	if (file == nullptr) {
+		return;
+	}
+
+	if (dirty) {
+		if (free_bytes >= PACKED_COMPACT_MIN_FREE && free_bytes >= data_end * PACKED_COMPACT_RATIO) {
+			compact();
+		}
+
+		if (file != nullptr && !writeIndex()) {
+			std::cout << "ERROR: The notes container's index could not be saved. It will be rebuilt next time." << std::endl;
+		}
+	}
+
+	if (file != nullptr) {
+		fclose(file);
+	}
+}
+
+/**
+ * Build the container as "<PACKED_NOTES_PATH>.tmp". Nothing opens that name, so if the program dies while packing,
+ * the graph still uses its .txt files, and the next pack starts over.
+ */
+bool PackedStorage::pack(NoteStorage& from, const std::string& graph_path) {
+	std::string temp_name = PACKED_NOTES_PATH + ".tmp";
+	std::error_code error;
+	fs::remove(graph_path + temp_name, error);
+
+	bool copied;
+	{
+		PackedStorage packed(graph_path, temp_name);
+		packed.durable = false;
+		copied = packed.file != nullptr && copyNotes(from, packed, graph_path);
+
+		//Sync everything now, so the index written when it's closed is only written after the notes are on the disk
+		copied = copied && FileIO::syncFile(packed.file);
+		packed.durable = true;
+	}
+
+	if (copied) {
+		fs::rename(graph_path + temp_name, graph_path + PACKED_NOTES_PATH, error);
+	}
+	if (!copied || error) {
+		fs::remove(graph_path + temp_name, error);
+		return false;
+	}
+
+	return true;
+}
+
+bool PackedStorage::read(const std::string& path, std::string& out) {
+	std::lock_guard<std::mutex> guard(lock);
+	out.clear();
+
+	auto found = notes.find(getTitle(path));
+	if (file == nullptr || found == notes.end()) {
+		return false;
+	}
+
+	return readText(found->second, out);
+}
+
+//Seek past the slot's header and title, then read the text straight into the string.
+bool PackedStorage::readText(const Slot& slot, std::string& out) {
+	out.resize((size_t)slot.text_length);
+	if (!FileIO::seekFile(file, slot.offset + SLOT_HEADER_LENGTH + slot.title_length)) {
+		return false;
+	}
+	if (slot.text_length > 0 && fread(&out[0], 1, out.size(), file) != out.size()) {
+		out.clear();
+		return false;
+	}
+
+	return true;
+}
+
+//Write the new slot first, so the note is never lost, then free the old one.
+bool PackedStorage::write(const std::string& path, const TextSnapshot& text) {
+	std::lock_guard<std::mutex> guard(lock);
+	if (file == nullptr || !markDirty()) {
+		return false;
+	}
+
+	std::string title = getTitle(path);
+	Slot slot;
+	if (!writeSlot(SLOT_NOTE, title, text, &slot)) {
+		return false;
+	}
+
+	auto found = notes.find(title);
+	if (found != notes.end()) {
+		releaseSlot(found->second.offset, found->second.capacity);
+		found->second = slot;
+	}
+	else {
+		notes[title] = slot;
+	}
+
+	return true;
+}
+
+bool PackedStorage::exists(const std::string& path) {
+	std::lock_guard<std::mutex> guard(lock);
+	return notes.count(getTitle(path)) > 0;
+}
+
+//Free the slot, and sync so the note doesn't come back if the program dies.
+bool PackedStorage::remove(const std::string& path) {
+	std::lock_guard<std::mutex> guard(lock);
+
+	auto found = notes.find(getTitle(path));
+	if (file == nullptr || found == notes.end() || !markDirty()) {
+		return false;
+	}
+
+	releaseSlot(found->second.offset, found->second.capacity);
+	notes.erase(found);
+
+	return FileIO::syncFile(file);
+}
+
+/**
+ * The title is part of the slot, so the text is copied into a new slot with the new title. The old slot is freed and
+ * synced right away, or the note would come back under its old title if the program died. Everything happens under
+ * one lock, so a save of the old title can't land between reading the text and freeing its slot.
+ */
+bool PackedStorage::rename(const std::string& old_path, const std::string& new_path) {
+	std::lock_guard<std::mutex> guard(lock);
+	std::string old_title = getTitle(old_path);
+	std::string new_title = getTitle(new_path);
+
+	auto found = notes.find(old_title);
+	std::string text;
+	if (file == nullptr || found == notes.end() || !readText(found->second, text) || !markDirty()) {
+		return false;
+	}
+
+	Slot slot;
+	if (!writeSlot(SLOT_NOTE, new_title, StringSnapshot(std::move(text)), &slot)) {
+		return false;
+	}
+
+	releaseSlot(found->second.offset, found->second.capacity);
+	notes.erase(found);
+
+	//A note already at the new title is replaced
+	auto replaced = notes.find(new_title);
+	if (replaced != notes.end()) {
+		releaseSlot(replaced->second.offset, replaced->second.capacity);
+	}
+	notes[new_title] = slot;
+
+	return FileIO::syncFile(file);
+}
+
+//Copy the titles, then hand them out without holding the lock.
+bool PackedStorage::list(const std::function<bool(std::string&&)>& found) {
+	std::vector<std::string> titles;
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if (file == nullptr) {
+			return false;
+		}
+
+		titles.reserve(notes.size());
+		for (const auto& note : notes) {
+			titles.push_back(note.first);
+		}
+	}
+
+	for (std::string& title : titles) {
+		if (!found(std::move(title))) {
+			break;
+		}
+	}
+
+	return true;
+}
+
+//Close the container, then delete it.
+bool PackedStorage::clear() {
+	std::lock_guard<std::mutex> guard(lock);
+	if (file != nullptr) {
+		fclose(file);
+		file = nullptr;
+	}
+
+	notes.clear();
+	free_space.clear();
+	free_sizes.clear();
+
+	std::error_code error;
+	fs::remove(container_path, error);
+	return !error;
+}
+
+//Take off the graph's directory from the front, and ".txt" from the end.
+std::string PackedStorage::getTitle(const std::string& path) const {
+	size_t start = (path.compare(0, graph_path.length(), graph_path) == 0) ? graph_path.length() : 0;
+	size_t end = path.length();
+	if (end - start >= 4 && path.compare(end - 4, 4, ".txt") == 0) {
+		end -= 4;
+	}
+
+	return path.substr(start, end - start);
+}
+
+/**
+ * Check the header, then use the index if the container was closed properly. Otherwise, or if the index is damaged,
+ * scan every slot.
+ */
+bool PackedStorage::load() {
+	std::string header(FILE_HEADER_LENGTH, '\0');
+	if (!FileIO::seekFile(file, 0) || fread(&header[0], 1, header.size(), file) != header.size()) {
+		return false;
+	}
+
+	//A container from a newer version may lay out its slots differently. It's left alone rather than rewritten
+	Uint32 version = GraphFile::readU32(header, FILE_VERSION_OFFSET);
+	if (std::memcmp(header.data(), PACKED_FILE_MAGIC, sizeof(PACKED_FILE_MAGIC)) != 0 || version == 0 || version > (Uint32)PACKED_FILE_VERSION
+		|| GraphFile::checksum(header.data(), header.data() + FILE_CHECKSUM_OFFSET) != GraphFile::readU32(header, FILE_CHECKSUM_OFFSET)) {
+		return false;
+	}
+
+	bool clean = (GraphFile::readU32(header, FILE_FLAGS_OFFSET) & FLAG_CLEAN) != 0;
+	sequence = GraphFile::readU64(header, FILE_SEQUENCE_OFFSET);
+
+	//The header still says the container is clean, so it has to be marked dirty before anything is changed
+	dirty = false;
+
+	if (clean && loadIndex(GraphFile::readU64(header, FILE_INDEX_POSITION_OFFSET), GraphFile::readU64(header, FILE_DATA_END_OFFSET))) {
+		return true;
+	}
+
+	std::cout << "The notes container wasn't closed properly. Reading every note to rebuild its index." << std::endl;
+	notes.clear();
+	free_space.clear();
+	free_sizes.clear();
+	free_bytes = 0;
+	index_offset = index_capacity = 0;
+	scan();
+
+	//The header is already marked dirty, and the index is written when the container is closed
+	dirty = true;
+
+	return true;
+
+}//END OF load()
+
+/**
+ * Read each entry of the index: the title, then the slot's position, size and text length. The entries are checked
+ * against each other and the size of the file, then the gaps between the slots are the free space.
+ */
+bool PackedStorage::loadIndex(Uint64 index_offset, Uint64 data_end) {
+	std::error_code error;
+	Uint64 file_size = fs::file_size(container_path, error);
+	if (error || data_end < FILE_HEADER_LENGTH || data_end > file_size) {
+		return false;
+	}
+
+	this->data_end = data_end;
+
+	//A container with no index has no notes
+	if (index_offset == 0) {
+		addFree(FILE_HEADER_LENGTH, data_end - FILE_HEADER_LENGTH);
+		return true;
+	}
+
+	SlotHeader header;
+	if (index_offset < FILE_HEADER_LENGTH || index_offset >= data_end || !readSlotHeader(index_offset, &header)
+		|| header.kind != SLOT_INDEX || header.capacity > data_end - index_offset) {
+		return false;
+	}
+
+	std::string index((size_t)header.text_length, '\0');
+	if (!FileIO::seekFile(file, index_offset + SLOT_HEADER_LENGTH + header.title_length)
+		|| (!index.empty() && fread(&index[0], 1, index.size(), file) != index.size())) {
+		return false;
+	}
+
+	//The slots, sorted by position, to find the gaps between them
+	std::vector<std::pair<Uint64, Uint64>> used;
+	used.push_back({ index_offset, header.capacity });
+
+	size_t pos = 0;
+	while (pos < index.size()) {
+		if (index.size() - pos < 4) {
+			return false;
+		}
+		Uint32 title_length = GraphFile::readU32(index, pos);
+		pos += 4;
+
+		if (index.size() - pos < (Uint64)title_length + 24) {
+			return false;
+		}
+		std::string title = index.substr(pos, title_length);
+		pos += title_length;
+
+		Slot slot;
+		slot.offset = GraphFile::readU64(index, pos);
+		slot.capacity = GraphFile::readU64(index, pos + 8);
+		slot.text_length = GraphFile::readU64(index, pos + 16);
+		slot.title_length = title_length;
+		pos += 24;
+
+		if (slot.offset < FILE_HEADER_LENGTH || slot.offset > data_end || slot.capacity > data_end - slot.offset
+			|| slot.capacity < SLOT_HEADER_LENGTH + slot.title_length + slot.text_length) {
+			return false;
+		}
+
+		notes[title] = slot;
+		used.push_back({ slot.offset, slot.capacity });
+	}
+
+	std::sort(used.begin(), used.end());
+
+	Uint64 gap_start = FILE_HEADER_LENGTH;
+	for (const auto& slot : used) {
+		//slots can't overlap
+		if (slot.first < gap_start) {
+			return false;
+		}
+		if (slot.first > gap_start) {
+			addFree(gap_start, slot.first - gap_start);
+		}
+		gap_start = slot.first + slot.second;
+	}
+	if (data_end > gap_start) {
+		addFree(gap_start, data_end - gap_start);
+	}
+
+	//The index's slot stays in use until the container is changed
+	this->index_offset = index_offset;
+	index_capacity = header.capacity;
+
+	return true;
+
+}//END OF loadIndex()
+
+/**
+ * Read the slot headers one after another. A damaged header means a slot was being added to the end of the container
+ * when the program died, so everything after it is treated as free. Both copies of a note can be found if the program
+ * died while it was being saved, and the newer one is kept.
+ */
+void PackedStorage::scan() {
+	std::error_code error;
+	Uint64 file_size = fs::file_size(container_path, error);
+	if (error) {
+		file_size = 0;
+	}
+
+	//The sequence number of each note's slot
+	std::unordered_map<std::string, Uint64> sequences;
+
+	Uint64 offset = FILE_HEADER_LENGTH;
+	SlotHeader header;
+	while (offset + SLOT_HEADER_LENGTH <= file_size && readSlotHeader(offset, &header)) {
+		if (header.capacity < SLOT_HEADER_LENGTH || header.capacity % PACKED_SLOT_ALIGN != 0 || header.capacity > file_size - offset) {
+			break;
+		}
+
+		sequence = std::max(sequence, header.sequence);
+
+		bool used = false;
+		std::string title((size_t)header.title_length, '\0');
+		if (header.kind == SLOT_NOTE && SLOT_HEADER_LENGTH + header.title_length + header.text_length <= header.capacity
+			&& FileIO::seekFile(file, offset + SLOT_HEADER_LENGTH)
+			&& (title.empty() || fread(&title[0], 1, title.size(), file) == title.size())) {
+
+			auto found = notes.find(title);
+			if (found == notes.end() || sequences[title] < header.sequence) {
+				//this copy is newer, so the older copy's slot is free
+				if (found != notes.end()) {
+					addFree(found->second.offset, found->second.capacity);
+				}
+
+				Slot slot;
+				slot.offset = offset;
+				slot.capacity = header.capacity;
+				slot.title_length = header.title_length;
+				slot.text_length = header.text_length;
+				notes[title] = slot;
+				sequences[title] = header.sequence;
+				used = true;
+			}
+		}
+
+		//Free slots, old indexes, and older copies of notes are all free space
+		if (!used) {
+			addFree(offset, header.capacity);
+		}
+
+		offset += header.capacity;
+	}
+
+	data_end = offset;
+
+}//END OF scan()
+
+//Clear the clean flag, and sync it before anything else is written. The old index's slot is free from now on.
+bool PackedStorage::markDirty() {
+	if (dirty) {
+		return true;
+	}
+
+	if (!writeFileHeader(file, false, 0) || !FileIO::syncFile(file)) {
+		return false;
+	}
+
+	dirty = true;
+	if (index_capacity > 0) {
+		addFree(index_offset, index_capacity);
+		index_offset = index_capacity = 0;
+	}
+
+	return true;
+}
+
+/**
+ * Write the title and text, sync, then write the header and sync again. Until the header is written, the slot is still
+ * free space (inside a free header covering it, or past the end of the slots), so a save cut off partway is never read
+ * as a note, and never hides the slots after it.
+ */
+bool PackedStorage::writeSlot(Uint32 kind, const std::string& title, const TextSnapshot& text, Slot* out) {
+	SlotHeader header;
+	header.kind = kind;
+	header.title_length = title.length();
+	header.text_length = (Uint64)text.length();
+	header.capacity = alignSlot(SLOT_HEADER_LENGTH + header.title_length + header.text_length);
+	header.sequence = sequence + 1;
+
+	Uint64 offset;
+	if (!allocate(header.capacity, &offset)) {
+		std::cout << "ERROR: Space for the note could not be taken in the container. Title: " << title << std::endl;
+		return false;
+	}
+
+	bool written = FileIO::seekFile(file, offset + SLOT_HEADER_LENGTH)
+		&& fwrite(title.data(), 1, title.length(), file) == title.length()
+		&& text.write(file)
+		&& writePadding(file, header.capacity, SLOT_HEADER_LENGTH + header.title_length + header.text_length)
+		&& (!durable || FileIO::syncFile(file))
+		&& writeSlotHeader(file, offset, header)
+		&& (!durable || FileIO::syncFile(file));
+
+	if (!written) {
+		std::cout << "ERROR: The note could not be written to the container. Title: " << title << std::endl;
+
+		//Give the space back. If it's at the end of the slots, the end moves back instead
+		if (offset + header.capacity == data_end) {
+			data_end = offset;
+		}
+		else {
+			releaseSlot(offset, header.capacity);
+		}
+		return false;
+	}
+
+	sequence = header.sequence;
+	out->offset = offset;
+	out->capacity = header.capacity;
+	out->title_length = header.title_length;
+	out->text_length = header.text_length;
+
+	return true;
+
+}//END OF writeSlot()
+
+//Overwrite the slot's header with a free one of the same size.
+void PackedStorage::releaseSlot(Uint64 offset, Uint64 capacity) {
+	SlotHeader header;
+	header.kind = SLOT_FREE;
+	header.capacity = capacity;
+	writeSlotHeader(file, offset, header);
+
+	addFree(offset, capacity);
+}
+
+/**
+ * Use the smallest free space that fits. What's left of it gets a free header, so the slots can still be read one
+ * after another, and stays free. If nothing fits, the slot goes at the end.
+ *
+ * Free space is merged in memory only, so on the disk it can still be several free slots, each with its own header.
+ * Writing the new slot would overwrite the headers inside it, so one free header covering all of it is written and
+ * synced first. Until the new slot's header is written, the whole space is then skipped as one free slot.
+ */
+bool PackedStorage::allocate(Uint64 capacity, Uint64* offset) {
+	auto best = free_sizes.lower_bound({ capacity, 0 });
+	if (best == free_sizes.end()) {
+		*offset = data_end;
+		data_end += capacity;
+		return true;
+	}
+
+	*offset = best->second;
+	Uint64 space = best->first;
+	takeFree(free_space.find(*offset));
+
+	SlotHeader header;
+	header.kind = SLOT_FREE;
+	header.capacity = space;
+	bool covered = writeSlotHeader(file, *offset, header);
+
+	if (covered && space > capacity) {
+		releaseSlot(*offset + capacity, space - capacity);
+	}
+
+	if (!covered || (durable && !FileIO::syncFile(file))) {
+		//Nothing inside the space was overwritten, so it's all still free
+		if (space > capacity) {
+			takeFree(free_space.find(*offset + capacity));
+		}
+		addFree(*offset, space);
+		return false;
+	}
+
+	return true;
+}
+
+//Join the space with the free space touching either side of it.
+void PackedStorage::addFree(Uint64 offset, Uint64 capacity) {
+	auto next = free_space.find(offset + capacity);
+	if (next != free_space.end()) {
+		capacity += next->second;
+		takeFree(next);
+	}
+
+	auto previous = free_space.lower_bound(offset);
+	if (previous != free_space.begin()) {
+		previous--;
+		if (previous->first + previous->second == offset) {
+			offset = previous->first;
+			capacity += previous->second;
+			takeFree(previous);
+		}
+	}
+
+	free_space[offset] = capacity;
+	free_sizes.insert({ capacity, offset });
+	free_bytes += capacity;
+}
+
+//Remove the space from both maps.
+void PackedStorage::takeFree(std::map<Uint64, Uint64>::iterator space) {
+	free_bytes -= space->second;
+	free_sizes.erase({ space->second, space->first });
+	free_space.erase(space);
+}
+
+/**
+ * The index is a list of every note: the length of its title, its title, then its slot's position, size and text
+ * length. It's written like a note, then the header is pointed at it and marked clean.
+ */
+bool PackedStorage::writeIndex() {
+	std::string index;
+	for (const auto& note : notes) {
+		size_t pos = index.size();
+		index.resize(pos + 4 + note.first.length() + 24);
+
+		GraphFile::writeU32(index, pos, (Uint32)note.first.length());
+		index.replace(pos + 4, note.first.length(), note.first);
+		pos += 4 + note.first.length();
+
+		GraphFile::writeU64(index, pos, note.second.offset);
+		GraphFile::writeU64(index, pos + 8, note.second.capacity);
+		GraphFile::writeU64(index, pos + 16, note.second.text_length);
+	}
+
+	Slot slot;
+	if (!writeSlot(SLOT_INDEX, "", StringSnapshot(std::move(index)), &slot)) {
+		return false;
+	}
+
+	if (!writeFileHeader(file, true, slot.offset) || !FileIO::syncFile(file)) {
+		return false;
+	}
+
+	index_offset = slot.offset;
+	index_capacity = slot.capacity;
+	dirty = false;
+
+	return true;
+
+}//END OF writeIndex()
+
+/**
+ * Copy the notes in the order they're in the container, so it's read from front to back, into slots packed one after
+ * another. The new container is synced once at the end instead of after every note, as the old one is kept until the
+ * new one is complete. Its header isn't marked clean, so if the program dies before its index is written it's scanned.
+ */
+bool PackedStorage::compact() {
+	std::string temp_path = container_path + ".tmp";
+	FILE* packed = FileIO::openFile(temp_path, "wb");
+	if (packed == nullptr) {
+		return false;
+	}
+
+	std::vector<std::pair<Uint64, const std::string*>> order;
+	order.reserve(notes.size());
+	for (const auto& note : notes) {
+		order.push_back({ note.second.offset, &note.first });
+	}
+	std::sort(order.begin(), order.end());
+
+	std::unordered_map<std::string, Slot> packed_notes;
+	Uint64 packed_end = FILE_HEADER_LENGTH;
+	bool written = true;
+
+	std::string contents;
+	for (const auto& note : order) {
+		const std::string& title = *note.second;
+		const Slot& old_slot = notes[title];
+
+		//Read the slot's title and text together, they're written back the same way
+		contents.resize((size_t)(old_slot.title_length + old_slot.text_length));
+		written = FileIO::seekFile(file, old_slot.offset + SLOT_HEADER_LENGTH)
+			&& (contents.empty() || fread(&contents[0], 1, contents.size(), file) == contents.size());
+		if (!written) {
+			break;
+		}
+
+		SlotHeader header;
+		header.kind = SLOT_NOTE;
+		header.title_length = old_slot.title_length;
+		header.text_length = old_slot.text_length;
+		header.capacity = alignSlot(SLOT_HEADER_LENGTH + contents.size());
+		header.sequence = ++sequence;
+
+		written = writeSlotHeader(packed, packed_end, header)
+			&& fwrite(contents.data(), 1, contents.size(), packed) == contents.size()
+			&& writePadding(packed, header.capacity, SLOT_HEADER_LENGTH + contents.size());
+		if (!written) {
+			break;
+		}
+
+		Slot slot = old_slot;
+		slot.offset = packed_end;
+		slot.capacity = header.capacity;
+		packed_notes[title] = slot;
+
+		packed_end += header.capacity;
+	}
+
+	//The header is written last, as it needs the end of the slots
+	Uint64 old_end = data_end;
+	data_end = packed_end;
+	written = written && writeFileHeader(packed, false, 0) && FileIO::syncFile(packed);
+	written = (fclose(packed) == 0) && written;
+
+	std::error_code error;
+	if (!written) {
+		data_end = old_end;
+		fs::remove(temp_path, error);
+		std::cout << "ERROR: The notes container could not be compacted. Path: " << container_path << std::endl;
+		return false;
+	}
+
+	//Swap the containers. The old one has to be closed first on Windows
+	fclose(file);
+	fs::rename(temp_path, container_path, error);
+	file = FileIO::openFile(container_path, "r+b");
+	if (error || file == nullptr) {
+		std::cout << "ERROR: The compacted notes container could not be opened. Path: " << container_path << std::endl;
+		if (file != nullptr) {
+			fclose(file);
+			file = nullptr;
+		}
+		return false;
+	}
+
+	notes = std::move(packed_notes);
+	free_space.clear();
+	free_sizes.clear();
+	free_bytes = 0;
+	index_offset = index_capacity = 0;
+	dirty = true;
+
+	return true;
+
+}//END OF compact()
+
+//Read the header's bytes, and check them against its checksum before using any of them.
+bool PackedStorage::readSlotHeader(Uint64 offset, SlotHeader* out) {
+	std::string header(SLOT_HEADER_LENGTH, '\0');
+	if (!FileIO::seekFile(file, offset) || fread(&header[0], 1, header.size(), file) != header.size()) {
+		return false;
+	}
+
+	if (GraphFile::checksum(header.data(), header.data() + SLOT_CHECKSUM_OFFSET) != GraphFile::readU32(header, SLOT_CHECKSUM_OFFSET)) {
+		return false;
+	}
+
+	out->kind = GraphFile::readU32(header, SLOT_KIND_OFFSET);
+	out->title_length = GraphFile::readU32(header, SLOT_TITLE_LENGTH_OFFSET);
+	out->capacity = GraphFile::readU64(header, SLOT_CAPACITY_OFFSET);
+	out->sequence = GraphFile::readU64(header, SLOT_SEQUENCE_OFFSET);
+	out->text_length = GraphFile::readU64(header, SLOT_TEXT_LENGTH_OFFSET);
+
+	return true;
+}
+
+bool PackedStorage::writeSlotHeader(FILE* target, Uint64 offset, const SlotHeader& header) {
+	std::string bytes(SLOT_HEADER_LENGTH, '\0');
+	GraphFile::writeU32(bytes, SLOT_KIND_OFFSET, header.kind);
+	GraphFile::writeU32(bytes, SLOT_TITLE_LENGTH_OFFSET, (Uint32)header.title_length);
+	GraphFile::writeU64(bytes, SLOT_CAPACITY_OFFSET, header.capacity);
+	GraphFile::writeU64(bytes, SLOT_SEQUENCE_OFFSET, header.sequence);
+	GraphFile::writeU64(bytes, SLOT_TEXT_LENGTH_OFFSET, header.text_length);
+	GraphFile::writeU32(bytes, SLOT_CHECKSUM_OFFSET, GraphFile::checksum(bytes.data(), bytes.data() + SLOT_CHECKSUM_OFFSET));
+
+	return FileIO::seekFile(target, offset) && fwrite(bytes.data(), 1, bytes.size(), target) == bytes.size();
+}
+
+//The end of the slots and the sequence number are always the container's current ones.
+bool PackedStorage::writeFileHeader(FILE* target, bool clean, Uint64 index_offset) {
+	std::string bytes(FILE_HEADER_LENGTH, '\0');
+	bytes.replace(0, sizeof(PACKED_FILE_MAGIC), PACKED_FILE_MAGIC, sizeof(PACKED_FILE_MAGIC));
+	GraphFile::writeU32(bytes, FILE_VERSION_OFFSET, PACKED_FILE_VERSION);
+	GraphFile::writeU32(bytes, FILE_FLAGS_OFFSET, clean ? FLAG_CLEAN : 0);
+	GraphFile::writeU64(bytes, FILE_INDEX_POSITION_OFFSET, index_offset);
+	GraphFile::writeU64(bytes, FILE_DATA_END_OFFSET, data_end);
+	GraphFile::writeU64(bytes, FILE_SEQUENCE_OFFSET, sequence);
+	GraphFile::writeU32(bytes, FILE_CHECKSUM_OFFSET, GraphFile::checksum(bytes.data(), bytes.data() + FILE_CHECKSUM_OFFSET));
+
+	return FileIO::seekFile(target, 0) && fwrite(bytes.data(), 1, bytes.size(), target) == bytes.size();
+}
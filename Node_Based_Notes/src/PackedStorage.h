@@ -0,0 +1,260 @@
+/*
+ * PackedStorage keeps every note of a graph in one container file, PACKED_NOTES_PATH in the graph's directory. With
+ * 100k+ notes, a file for each note makes opening, saving, listing and backing up a graph cost a system call (and an
+ * inode) per note. A container is one file, listed from memory, and read or written with a seek.
+ *
+ * The container is a header followed by slots. Each slot starts with its own header (its kind, its size, a sequence
+ * number and a checksum), then holds the title and text of one note:
+ *	* A note is saved into a new slot: the text is written and synced, then the slot's header, so the old slot holds
+ *	  the note until the new one is complete. The old slot is then marked free
+ *	* Free slots are reused for later saves (the smallest one that fits), and split if they're much bigger
+ *	* When the container is closed, the index of every note's slot is written into a slot of its own, and the header
+ *	  points to it. Opening a container that was closed properly reads just the index
+ *	* If the program died with the container open, it's opened by reading every slot header instead. A note found in
+ *	  two slots keeps the one with the highest sequence number
+ *	* When the container is closed with at least PACKED_COMPACT_RATIO of it free, it's rewritten with the notes packed
+ *	  together, and replaces the old one in one step
+ *
+ * Every number is little-endian, and every slot is a multiple of PACKED_SLOT_ALIGN bytes.
+ *
+ * Author: Connor Kamrowski
+ */
+#pragma once
+#include "Config.h"
+#include "NoteStorage.h"
+#include "FileIO.h"
+
+#include <map>
+#include <set>
+#include <mutex>
+#include <unordered_map>
+
+class PackedStorage : public NoteStorage {
+public:
+	/**
+	 * PackedStorage constructor. Opens the graph's container, creating it if it doesn't exist.
+	 *
+	 * \param graph_path: The path of the graph's directory, ending in '/'
+	 * \param container_name: The name of the container file in the graph's directory
+	 */
+	PackedStorage(const std::string& graph_path, const std::string& container_name = PACKED_NOTES_PATH);
+
+	/**
+	 * Copy every note of a graph into a new container. The container is built under a temporary name, and only
+	 * renamed into place once every note is in it, so a graph is never left with only some of its notes packed.
+	 *
+	 * \param from: The storage the notes are in now
+	 * \param graph_path: The path of the graph's directory, ending in '/'
+	 * \return false if the container couldn't be built. The notes are left in 'from'
+	 */
+	static bool pack(NoteStorage& from, const std::string& graph_path);
+
+	/**
+	 * PackedStorage deconstructor. Compacts the container if enough of it is free, then writes the index and closes it.
+	 */
+	~PackedStorage();
+
+	/**
+	 * Read the note's text from its slot.
+	 */
+	bool read(const std::string& path, std::string& out);
+
+	/**
+	 * Save the note into a new slot, then free its old one.
+	 */
+	bool write(const std::string& path, const TextSnapshot& text);
+
+	/**
+	 * \return true if the note is in the container.
+	 */
+	bool exists(const std::string& path);
+
+	/**
+	 * Free the note's slot.
+	 */
+	bool remove(const std::string& path);
+
+	/**
+	 * Save the note's text under its new title, then free its old slot.
+	 */
+	bool rename(const std::string& old_path, const std::string& new_path);
+
+	/**
+	 * List the titles in the index. The container isn't read.
+	 */
+	bool list(const std::function<bool(std::string&&)>& found);
+
+	/**
+	 * Delete the container file. The storage can't be used afterwards.
+	 */
+	bool clear();
+
+	/**
+	 * \return true, every note is in the container.
+	 */
+	bool isPacked() const { return true; }
+
+private:
+	//Where a note is in the container
+	struct Slot {
+		//The position of the slot, and its size including its header
+		Uint64 offset = 0;
+		Uint64 capacity = 0;
+
+		//The length of the note's title and text, which come right after the slot's header
+		Uint64 title_length = 0;
+		Uint64 text_length = 0;
+	};
+
+	//The header at the start of every slot
+	struct SlotHeader {
+		Uint32 kind = 0;
+		Uint64 capacity = 0;
+		Uint64 sequence = 0;
+		Uint64 title_length = 0;
+		Uint64 text_length = 0;
+	};
+
+	/**
+	 * \return The title of a note from its path, which is the path minus the graph's directory and ".txt".
+	 */
+	std::string getTitle(const std::string& path) const;
+
+	/**
+	 * Read a note's text from its slot. The caller must hold the lock.
+	 *
+	 * \param slot: The note's slot
+	 * \param out: The string the text is read into
+	 * \return false if the text couldn't be read
+	 */
+	bool readText(const Slot& slot, std::string& out);
+
+	/**
+	 * Read the container's header, then its index. If the index can't be used, every slot is read instead.
+	 *
+	 * \return false if the file isn't a container, or was written by a newer version
+	 */
+	bool load();
+
+	/**
+	 * Read the index from its slot, and find the free space between the notes.
+	 *
+	 * \return false if the index is damaged
+	 */
+	bool loadIndex(Uint64 index_offset, Uint64 data_end);
+
+	/**
+	 * Find every note by reading each slot header in turn, stopping at the first damaged one.
+	 */
+	void scan();
+
+	/**
+	 * Mark the container as changed in its header, so it's scanned if the program dies before it's closed. Done once,
+	 * before the first change since the container was opened or last closed.
+	 *
+	 * \return false if the header couldn't be written
+	 */
+	bool markDirty();
+
+	/**
+	 * Save the title and text into a slot, reusing free space if there's enough. The slot's header is written last,
+	 * and everything is synced.
+	 *
+	 * \param kind: The kind of slot
+	 * \param title: The title of the note. Empty for the index
+	 * \param text: The text of the note, or the index
+	 * \param out: Set to the new slot
+	 * \return false if the slot couldn't be written. The space is freed again
+	 */
+	bool writeSlot(Uint32 kind, const std::string& title, const TextSnapshot& text, Slot* out);
+
+	/**
+	 * Mark a slot as free, on the disk and in memory.
+	 */
+	void releaseSlot(Uint64 offset, Uint64 capacity);
+
+	/**
+	 * Take space for a slot, from the smallest free space it fits in, or from the end of the container. Free space is
+	 * covered by a single free header on the disk before it's used.
+	 *
+	 * \param capacity: The size of the slot, a multiple of PACKED_SLOT_ALIGN
+	 * \param offset: Set to the position of the slot
+	 * \return false if the free space couldn't be prepared. It's left free
+	 */
+	bool allocate(Uint64 capacity, Uint64* offset);
+
+	/**
+	 * Add space to the free space, merging it with any free space right before or after it.
+	 */
+	void addFree(Uint64 offset, Uint64 capacity);
+
+	/**
+	 * Take space out of the free space. It must be one whole piece of the free space.
+	 */
+	void takeFree(std::map<Uint64, Uint64>::iterator space);
+
+	/**
+	 * Write the index into a new slot, then point the header at it and mark the container as closed properly.
+	 */
+	bool writeIndex();
+
+	/**
+	 * Copy every note into a new container with no free space, and replace the old container with it.
+	 *
+	 * \return false if the new container couldn't be written. The old one is kept
+	 */
+	bool compact();
+
+	/**
+	 * Read or write a slot header. A header read that fails its checksum is treated as damaged.
+	 */
+	bool readSlotHeader(Uint64 offset, SlotHeader* out);
+	bool writeSlotHeader(FILE* target, Uint64 offset, const SlotHeader& header);
+
+	/**
+	 * Write the container's header.
+	 *
+	 * \param target: The container file
+	 * \param clean: Indicates that the index is up to date
+	 * \param index_offset: The position of the index's slot
+	 */
+	bool writeFileHeader(FILE* target, bool clean, Uint64 index_offset);
+
+	//The path of the graph's directory, and of the container
+	std::string graph_path;
+	std::string container_path;
+
+	//The open container. Null if it couldn't be opened, or was deleted
+	FILE* file = nullptr;
+
+	//The slot of every note, by title
+	std::unordered_map<std::string, Slot> notes;
+
+	//The free space, by position, and by size then position
+	std::map<Uint64, Uint64> free_space;
+	std::set<std::pair<Uint64, Uint64>> free_sizes;
+
+	//The number of bytes of free space
+	Uint64 free_bytes = 0;
+
+	//The end of the last slot. New slots that don't fit in the free space go here
+	Uint64 data_end = 0;
+
+	//The sequence number of the last slot written
+	Uint64 sequence = 0;
+
+	//The slot the index was read from. It's freed once the container is changed, as the index is then out of date
+	Uint64 index_offset = 0;
+	Uint64 index_capacity = 0;
+
+	//Indicates that the container was changed since its index was written
+	bool dirty = false;
+
+	//Indicates that each slot is synced as it's written. Turned off while packing, as the whole container is thrown
+	//away if packing is cut off
+	bool durable = true;
+
+	//Guards everything above, and the file
+	std::mutex lock;
+
+};
@@ -0,0 +1,287 @@
+//Author: Connor Kamrowski. See header file for more information.
+#include "Rope.h"
+
+/**
+ * The Rope constructor. An empty rope has no nodes at all.
+ */
+Rope::Rope() {}
+
+//Build a balanced tree from the text, and put the cursor at the end.
+void Rope::assign(const char* text, int count) {
+	root = build(text, count);
+	cursor = anchor = count;
+}
+
+//Walk down to the leaf holding position.
+char Rope::at(int position) const {
+	const RopeNode* node = root.get();
+
+	while (node->left) {
+		if (position < node->left->length) {
+			node = node->left.get();
+		}
+		else {
+			position -= node->left->length;
+			node = node->right.get();
+		}
+	}
+
+	return node->text[position];
+}
+
+//Copy a range of the text, gathering it from each leaf it covers.
+void Rope::copy(int start, int count, std::string& out) const {
+	out.clear();
+	out.reserve(count);
+
+	copyNode(root, start, count, out);
+}
+
+//A snapshot is just the current root. Later edits make new nodes, so the snapshot never changes.
+std::shared_ptr<const TextSnapshot> Rope::snapshot() const {
+	return std::make_shared<RopeSnapshot>(root);
+}
+
+//Append the part of each leaf that falls in the range.
+void Rope::copyNode(const RopeNodePtr& node, int start, int count, std::string& out) {
+	if (!node || count <= 0) {
+		return;
+	}
+
+	if (!node->left) {
+		out.append(node->text, start, count);
+		return;
+	}
+
+	int left_length = node->left->length;
+
+	//The part of the range in the left child
+	if (start < left_length) {
+		copyNode(node->left, start, std::min(count, left_length - start), out);
+	}
+
+	//The part of the range in the right child
+	int end = start + count;
+	if (end > left_length) {
+		int right_start = std::max(start, left_length);
+		copyNode(node->right, right_start - left_length, end - right_start, out);
+	}
+}
+
+//Insert into the one leaf holding position, and rebuild the branches above it.
+void Rope::insertAt(int position, const char* text, int count) {
+	if (count <= 0) {
+		return;
+	}
+
+	root = root ? insertNode(root, position, text, count) : build(text, count);
+}
+
+//Remove the range, rebuilding only the branches along its two ends.
+void Rope::eraseAt(int position, int count) {
+	if (count <= 0) {
+		return;
+	}
+
+	root = eraseNode(root, position, count);
+}
+
+//Make a leaf holding a copy of the text.
+RopeNodePtr Rope::makeLeaf(const char* text, int count) {
+	std::shared_ptr<RopeNode> leaf = std::make_shared<RopeNode>();
+	leaf->text.assign(text, count);
+	leaf->length = count;
+
+	return leaf;
+}
+
+//Make a branch, adding up the lengths of its children.
+RopeNodePtr Rope::makeBranch(const RopeNodePtr& left, const RopeNodePtr& right) {
+	if (!left) {
+		return right;
+	}
+	if (!right) {
+		return left;
+	}
+
+	std::shared_ptr<RopeNode> branch = std::make_shared<RopeNode>();
+	branch->left = left;
+	branch->right = right;
+	branch->length = left->length + right->length;
+	branch->height = std::max(left->height, right->height) + 1;
+
+	return branch;
+}
+
+/**
+ * Join two trees whose heights differ by at most 2, rotating if needed so the result's children differ by at most 1.
+ * These are the usual AVL rotations, except new nodes are made instead of changing the old ones.
+ */
+RopeNodePtr Rope::balance(const RopeNodePtr& left, const RopeNodePtr& right) {
+	int left_height = left ? left->height : 0;
+	int right_height = right ? right->height : 0;
+
+	if (left_height > right_height + 1) {
+		if (left->left->height >= left->right->height) {
+			//single rotation to the right
+			return makeBranch(left->left, makeBranch(left->right, right));
+		}
+
+		//double rotation, the middle grandchild becomes the new root
+		const RopeNodePtr& middle = left->right;
+		return makeBranch(makeBranch(left->left, middle->left), makeBranch(middle->right, right));
+	}
+
+	if (right_height > left_height + 1) {
+		if (right->right->height >= right->left->height) {
+			//single rotation to the left
+			return makeBranch(makeBranch(left, right->left), right->right);
+		}
+
+		//double rotation, the middle grandchild becomes the new root
+		const RopeNodePtr& middle = right->left;
+		return makeBranch(makeBranch(left, middle->left), makeBranch(middle->right, right->right));
+	}
+
+	return makeBranch(left, right);
+
+}//END OF balance()
+
+/**
+ * Join two trees. If one is much taller, walk down its inner edge until the heights are close, join there, and
+ * balance each branch on the way back up. This takes time proportional to the difference in heights.
+ */
+RopeNodePtr Rope::join(const RopeNodePtr& left, const RopeNodePtr& right) {
+	if (!left) {
+		return right;
+	}
+	if (!right) {
+		return left;
+	}
+
+	//Two small leaves become one, so edits don't leave the tree full of tiny leaves
+	if (!left->left && !right->left && left->length + right->length <= ROPE_LEAF_SIZE) {
+		std::string text = left->text + right->text;
+		return makeLeaf(text.c_str(), (int)text.length());
+	}
+
+	if (left->height > right->height + 1) {
+		return balance(left->left, join(left->right, right));
+	}
+
+	if (right->height > left->height + 1) {
+		return balance(join(left, right->left), right->right);
+	}
+
+	return makeBranch(left, right);
+
+}//END OF join()
+
+//Split the text into full leaves, and pair them up into a balanced tree.
+RopeNodePtr Rope::build(const char* text, int count) {
+	if (count <= 0) {
+		return nullptr;
+	}
+
+	if (count <= ROPE_LEAF_SIZE) {
+		return makeLeaf(text, count);
+	}
+
+	//Give each half an equal number of leaves (the left may have one more), so the halves differ in height by at most 1
+	int leaf_count = (count + ROPE_LEAF_SIZE - 1) / ROPE_LEAF_SIZE;
+	int left_count = ((leaf_count + 1) / 2) * ROPE_LEAF_SIZE;
+
+	return makeBranch(build(text, left_count), build(text + left_count, count - left_count));
+}
+
+/**
+ * Insert text into the leaf holding position. If the leaf grows too big, it's rebuilt as a small tree, and the
+ * branches above are joined back together on the way up.
+ */
+RopeNodePtr Rope::insertNode(const RopeNodePtr& node, int position, const char* text, int count) {
+	if (!node->left) {
+		std::string combined = node->text;
+		combined.insert(position, text, count);
+
+		return build(combined.c_str(), (int)combined.length());
+	}
+
+	//Text at the boundary goes to the end of the left child, which is usually where the user is typing
+	if (position <= node->left->length) {
+		return join(insertNode(node->left, position, text, count), node->right);
+	}
+
+	return join(node->left, insertNode(node->right, position - node->left->length, text, count));
+}
+
+/**
+ * Erase a range from a node. Children entirely outside of the range are kept as they are, and children the range
+ * ends in are trimmed, so only the two edges of the range are rebuilt.
+ */
+RopeNodePtr Rope::eraseNode(const RopeNodePtr& node, int position, int count) {
+	if (!node || count <= 0) {
+		return node;
+	}
+
+	//The whole node is erased
+	if (position <= 0 && count >= node->length) {
+		return nullptr;
+	}
+
+	if (!node->left) {
+		std::string remaining = node->text;
+		remaining.erase(position, count);
+
+		return makeLeaf(remaining.c_str(), (int)remaining.length());
+	}
+
+	int left_length = node->left->length;
+	int end = position + count;
+
+	//The range is only in the left child
+	if (end <= left_length) {
+		return join(eraseNode(node->left, position, count), node->right);
+	}
+
+	//The range is only in the right child
+	if (position >= left_length) {
+		return join(node->left, eraseNode(node->right, position - left_length, count));
+	}
+
+	//The range covers the end of the left child, and the start of the right child
+	return join(eraseNode(node->left, position, left_length - position), eraseNode(node->right, 0, end - left_length));
+
+}//END OF eraseNode()
+
+//Write each leaf in order.
+bool RopeSnapshot::write(FILE* file) const {
+	if (!root) {
+		return true;
+	}
+
+	//walk the tree without recursion, visiting the leaves from left to right
+	std::vector<const RopeNode*> stack = { root.get() };
+	while (!stack.empty()) {
+		const RopeNode* node = stack.back();
+		stack.pop_back();
+
+		if (node->left) {
+			stack.push_back(node->right.get());
+			stack.push_back(node->left.get());
+		}
+		else if (fwrite(node->text.data(), 1, node->length, file) != (size_t)node->length) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//Copy every leaf into one string.
+std::string RopeSnapshot::toString() const {
+	std::string text;
+	text.reserve(length());
+
+	Rope::copyNode(root, 0, length(), text);
+	return text;
+}
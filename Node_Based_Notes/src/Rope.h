@@ -0,0 +1,158 @@
+/*
+ * Rope is the text model the text editor uses for very large notes (anything over ROPE_THRESHOLD bytes). The text is
+ * split into chunks of at most ROPE_LEAF_SIZE characters, which are the leaves of a balanced (AVL) binary tree. Each
+ * branch knows the length of the text below it, so finding a position, inserting and deleting are all O(log n) instead
+ * of moving every character after the edit. Lines are found by the editor's TextLayout, which also knows where lines
+ * wrap.
+ *
+ * Nodes are never changed after they're made. An edit builds new nodes along the path to the leaf it changes and
+ * shares everything else, so a snapshot of the text is just a pointer to the current root.
+ *
+ * Author: Connor Kamrowski
+ */
+#pragma once
+#include "TextDocument.h"
+
+//A leaf or branch of a Rope. Leaves hold text, branches hold two children
+struct RopeNode {
+	//The children of a branch. Both are null for a leaf
+	std::shared_ptr<const RopeNode> left;
+	std::shared_ptr<const RopeNode> right;
+
+	//The text of a leaf. Empty for a branch
+	std::string text;
+
+	//The number of characters in this node and every node below it
+	int length = 0;
+
+	//The height of the tree below this node. Leaves have a height of 1
+	int height = 1;
+};
+
+typedef std::shared_ptr<const RopeNode> RopeNodePtr;
+
+//A snapshot of a Rope. It keeps the root alive, so the nodes it uses are never freed while it exists
+class RopeSnapshot : public TextSnapshot {
+public:
+	/**
+	 * RopeSnapshot constructor.
+	 *
+	 * \param root: The root of the rope being saved
+	 */
+	RopeSnapshot(RopeNodePtr root) : root(root) {}
+
+	int length() const { return root ? root->length : 0; }
+	bool write(FILE* file) const;
+	std::string toString() const;
+
+private:
+	//The root of the rope when the snapshot was taken
+	RopeNodePtr root;
+
+};
+
+class Rope : public TextDocument {
+public:
+	/**
+	 * Rope constructor. The rope starts empty, with the cursor at 0.
+	 */
+	Rope();
+
+	/**
+	 * Replace all of the text, and place the cursor at the end of it with nothing selected. The tree is built
+	 * already balanced, with full leaves.
+	 *
+	 * \param text: The new text
+	 * \param count: The number of characters in text
+	 */
+	void assign(const char* text, int count);
+
+	/**
+	 * \return The number of characters in the text.
+	 */
+	int length() const { return root ? root->length : 0; }
+
+	/**
+	 * \param position: The index of a character, from 0 to length() - 1
+	 * \return The character at position.
+	 */
+	char at(int position) const;
+
+	/**
+	 * Copy part of the text into a string.
+	 *
+	 * \param start: The index of the first character to copy
+	 * \param count: The number of characters to copy
+	 * \param out: The string the text is copied into. Its previous contents are replaced
+	 */
+	void copy(int start, int count, std::string& out) const;
+
+	/**
+	 * Take a snapshot of the text. Nothing is copied, the snapshot shares the rope's nodes.
+	 *
+	 * \return The snapshot
+	 */
+	std::shared_ptr<const TextSnapshot> snapshot() const;
+
+	/**
+	 * Append part of the text below a node to a string. Used by copy() and RopeSnapshot.
+	 *
+	 * \param node: The node to copy from
+	 * \param start: The index of the first character to copy, relative to node
+	 * \param count: The number of characters to copy
+	 * \param out: The string the text is appended to
+	 */
+	static void copyNode(const RopeNodePtr& node, int start, int count, std::string& out);
+
+protected:
+	/**
+	 * Insert text at a position, without touching the cursor.
+	 */
+	void insertAt(int position, const char* text, int count);
+
+	/**
+	 * Remove text at a position, without touching the cursor.
+	 */
+	void eraseAt(int position, int count);
+
+private:
+	/**
+	 * \return A new leaf holding the text.
+	 */
+	static RopeNodePtr makeLeaf(const char* text, int count);
+
+	/**
+	 * \return A new branch joining left and right, without balancing. If either is null, the other is returned.
+	 */
+	static RopeNodePtr makeBranch(const RopeNodePtr& left, const RopeNodePtr& right);
+
+	/**
+	 * \return A new branch joining left and right, with one rotation if their heights are 2 apart.
+	 */
+	static RopeNodePtr balance(const RopeNodePtr& left, const RopeNodePtr& right);
+
+	/**
+	 * Join two trees of any height into one balanced tree, with the text of left before the text of right.
+	 * Small neighbouring leaves are merged into one.
+	 */
+	static RopeNodePtr join(const RopeNodePtr& left, const RopeNodePtr& right);
+
+	/**
+	 * \return A balanced tree holding text, with every leaf but the last one full.
+	 */
+	static RopeNodePtr build(const char* text, int count);
+
+	/**
+	 * \return A copy of node with text inserted at position. Only the nodes on the path to position are copied.
+	 */
+	static RopeNodePtr insertNode(const RopeNodePtr& node, int position, const char* text, int count);
+
+	/**
+	 * \return A copy of node without the characters from position to position + count, or null if nothing is left.
+	 */
+	static RopeNodePtr eraseNode(const RopeNodePtr& node, int position, int count);
+
+	//The root of the tree. Null when the text is empty
+	RopeNodePtr root;
+
+};
@@ -0,0 +1,228 @@
+//Author: Connor Kamrowski. See header file for more information.
+#include "SpatialGrid.h"
+
+//Put the node in its cells, on top of everything inserted before it.
+void SpatialGrid::insert(NodeId id, const SDL_Rect& bounds) {
+	if (id >= (int)records.size()) {
+		records.resize(id + 1);
+	}
+
+	Record& record = records[id];
+	record.bounds = bounds;
+	record.order = next_order++;
+	record.present = true;
+	count++;
+
+	addToCells(record.bounds, { id, record.order, record.bounds });
+	addToCluster(getClusterKey(record.bounds), 1);
+}
+
+//Take the node out of its cells, and forget about it.
+void SpatialGrid::remove(NodeId id) {
+	if (id < 0 || id >= (int)records.size() || !records[id].present) {
+		return;
+	}
+
+	Record& record = records[id];
+	removeFromCells(record.bounds, id);
+	addToCluster(getClusterKey(record.bounds), -1);
+
+	record.present = false;
+	count--;
+}
+
+/**
+ * Move the node from the cells under its old shape to the cells under its new shape. It keeps its order, so moving a
+ * node doesn't change which nodes it's drawn above.
+ */
+void SpatialGrid::update(NodeId id, const SDL_Rect& bounds) {
+	if (id < 0 || id >= (int)records.size() || !records[id].present) {
+		return;
+	}
+
+	Record& record = records[id];
+	removeFromCells(record.bounds, id);
+
+	//Only the two clusters change if the node moved to another one
+	unsigned long long old_cluster = getClusterKey(record.bounds);
+
+	record.bounds = bounds;
+	addToCells(record.bounds, { id, record.order, record.bounds });
+
+	unsigned long long new_cluster = getClusterKey(record.bounds);
+	if (new_cluster != old_cluster) {
+		addToCluster(old_cluster, -1);
+		addToCluster(new_cluster, 1);
+	}
+}
+
+//Empty the grid, freeing its memory.
+void SpatialGrid::clear() {
+	cells.clear();
+	clusters.clear();
+	std::vector<Record>().swap(records);
+	count = 0;
+	next_order = 0;
+}
+
+/**
+ * Only the cell under the point needs to be checked, since every node is listed in each cell it overlaps. Of the nodes
+ * there that hold the point, the last one inserted is the one drawn on top.
+ */
+NodeId SpatialGrid::queryPoint(int x, int y) {
+	auto cell = cells.find(getCellKey(getCell(x), getCell(y)));
+	if (cell == cells.end()) {
+		return NO_NODE;
+	}
+
+	NodeId found = NO_NODE;
+	unsigned int found_order = 0;
+
+	for (const Entry& entry : cell->second) {
+		const SDL_Rect& shape = entry.bounds;
+
+		//The same test the graph has always used, the edges of the node don't count
+		if (x > shape.x && x < shape.x + shape.w && y > shape.y && y < shape.y + shape.h) {
+			if (found == NO_NODE || entry.order > found_order) {
+				found = entry.id;
+				found_order = entry.order;
+			}
+		}
+	}
+
+	return found;
+
+}//END OF queryPoint()
+
+/**
+ * Check the nodes in every cell the rectangle covers. A node covering several cells is found several times, so the
+ * results are sorted into drawing order and the repeats removed.
+ */
+void SpatialGrid::queryRect(const SDL_Rect& area, std::vector<NodeId>& out) {
+	out.clear();
+
+	int first_x, first_y, last_x, last_y;
+	getCellRange(area, &first_x, &first_y, &last_x, &last_y);
+
+	std::vector<Entry> hits;
+
+	for (int cell_y = first_y; cell_y <= last_y; cell_y++) {
+		for (int cell_x = first_x; cell_x <= last_x; cell_x++) {
+			auto cell = cells.find(getCellKey(cell_x, cell_y));
+			if (cell == cells.end()) {
+				continue;
+			}
+
+			for (const Entry& entry : cell->second) {
+				if (SDL_HasIntersection(&entry.bounds, &area)) {
+					hits.push_back(entry);
+				}
+			}
+		}
+	}
+
+	//sort into drawing order, and skip any node found in more than one cell
+	std::sort(hits.begin(), hits.end(), [](const Entry& a, const Entry& b) { return a.order < b.order; });
+
+	for (int i = 0; i < (int)hits.size(); i++) {
+		if (i == 0 || hits.at(i).order != hits.at(i - 1).order) {
+			out.push_back(hits.at(i).id);
+		}
+	}
+
+}//END OF queryRect()
+
+/**
+ * Look up each cluster cell in the area. If the area covers more cells than have nodes in them, it's faster to check
+ * every cell with nodes instead, so a very large area never costs more than the number of clusters.
+ */
+void SpatialGrid::queryClusters(const SDL_Rect& area, std::vector<Cluster>& out) {
+	out.clear();
+
+	int first_x = getClusterCell(area.x);
+	int first_y = getClusterCell(area.y);
+	int last_x = getClusterCell(area.x + area.w);
+	int last_y = getClusterCell(area.y + area.h);
+
+	long long area_cells = (long long)(last_x - first_x + 1) * (last_y - first_y + 1);
+
+	if (area_cells <= (long long)clusters.size()) {
+		for (int cell_y = first_y; cell_y <= last_y; cell_y++) {
+			for (int cell_x = first_x; cell_x <= last_x; cell_x++) {
+				auto cluster = clusters.find(getCellKey(cell_x, cell_y));
+				if (cluster != clusters.end()) {
+					out.push_back({ { cell_x * CLUSTER_CELL_SIZE, cell_y * CLUSTER_CELL_SIZE, CLUSTER_CELL_SIZE, CLUSTER_CELL_SIZE }, cluster->second });
+				}
+			}
+		}
+		return;
+	}
+
+	for (auto& cluster : clusters) {
+		//undo getCellKey()
+		int cell_x = (int)(unsigned int)(cluster.first >> 32);
+		int cell_y = (int)(unsigned int)(cluster.first & 0xFFFFFFFF);
+
+		if (cell_x >= first_x && cell_x <= last_x && cell_y >= first_y && cell_y <= last_y) {
+			out.push_back({ { cell_x * CLUSTER_CELL_SIZE, cell_y * CLUSTER_CELL_SIZE, CLUSTER_CELL_SIZE, CLUSTER_CELL_SIZE }, cluster.second });
+		}
+	}
+
+}//END OF queryClusters()
+
+//Use the center of the node, so each node is counted in exactly one cluster.
+unsigned long long SpatialGrid::getClusterKey(const SDL_Rect& bounds) {
+	return getCellKey(getClusterCell(bounds.x + bounds.w / 2), getClusterCell(bounds.y + bounds.h / 2));
+}
+
+//Change the count, removing the cluster when it's empty.
+void SpatialGrid::addToCluster(unsigned long long key, int amount) {
+	int& count = clusters[key];
+	count += amount;
+
+	if (count <= 0) {
+		clusters.erase(key);
+	}
+}
+
+//Convert the corners of the rectangle into cells.
+void SpatialGrid::getCellRange(const SDL_Rect& area, int* first_x, int* first_y, int* last_x, int* last_y) {
+	*first_x = getCell(area.x);
+	*first_y = getCell(area.y);
+	*last_x = getCell(area.x + area.w);
+	*last_y = getCell(area.y + area.h);
+}
+
+//List the entry in every cell the bounds overlap.
+void SpatialGrid::addToCells(const SDL_Rect& bounds, Entry entry) {
+	int first_x, first_y, last_x, last_y;
+	getCellRange(bounds, &first_x, &first_y, &last_x, &last_y);
+
+	for (int cell_y = first_y; cell_y <= last_y; cell_y++) {
+		for (int cell_x = first_x; cell_x <= last_x; cell_x++) {
+			cells[getCellKey(cell_x, cell_y)].push_back(entry);
+		}
+	}
+}
+
+//Remove the node from every cell the bounds overlap. Cells left empty are removed, so they don't use memory.
+void SpatialGrid::removeFromCells(const SDL_Rect& bounds, NodeId id) {
+	int first_x, first_y, last_x, last_y;
+	getCellRange(bounds, &first_x, &first_y, &last_x, &last_y);
+
+	for (int cell_y = first_y; cell_y <= last_y; cell_y++) {
+		for (int cell_x = first_x; cell_x <= last_x; cell_x++) {
+			auto cell = cells.find(getCellKey(cell_x, cell_y));
+			if (cell == cells.end()) {
+				continue;
+			}
+
+			std::vector<Entry>& entries = cell->second;
+			entries.erase(std::remove_if(entries.begin(), entries.end(), [&](const Entry& entry) { return entry.id == id; }), entries.end());
+
+			if (entries.empty()) {
+				cells.erase(cell);
+			}
+		}
+	}
+}
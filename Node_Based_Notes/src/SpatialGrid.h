@@ -0,0 +1,169 @@
+/*
+ * SpatialGrid is an index of the nodes in a graph by position, so finding the node under the mouse doesn't mean
+ * checking every node. The graph is divided into square cells of SPATIAL_GRID_CELL_SIZE, and each node is listed in
+ * every cell its shape overlaps. A point only needs to check the nodes in one cell, and a rectangle only the nodes in
+ * the cells it covers.
+ *
+ * Cells are stored in a hash map, so only cells holding nodes use memory, and the graph can extend in any direction.
+ *
+ * Nodes are drawn in the order they were added, so each node remembers when it was inserted. Queries use this to
+ * return the same node that's drawn on top. Each cell keeps a copy of its nodes' shapes, so a query never has to look
+ * anything up in the NodeStore.
+ *
+ * The grid also counts the nodes in larger cells of CLUSTER_CELL_SIZE, by the center of each node. The counts are
+ * changed as nodes are added, moved and removed, so a zoomed out graph can be drawn as one block per cluster without
+ * looking at the nodes at all.
+ *
+ * Author: Connor Kamrowski
+ */
+#pragma once
+#include "Config.h"
+#include "NodeStore.h"
+
+#include <unordered_map>
+#include <cmath>
+
+//A cell of nodes drawn as one block when the graph is zoomed out
+struct Cluster {
+	//The area of the cell, in world coordinates
+	SDL_Rect bounds;
+
+	//The number of nodes centered in the cell
+	int count;
+};
+
+class SpatialGrid {
+public:
+	/**
+	 * Add a node to the grid, in the cells under its shape. Give the grid to the NodeStore with
+	 * NodeStore::setIndex(), so moving the node with NodeStore::setPos() keeps the grid up to date.
+	 *
+	 * \param id: The node to add. It's drawn above every node already in the grid
+	 * \param bounds: The shape of the node
+	 */
+	void insert(NodeId id, const SDL_Rect& bounds);
+
+	/**
+	 * Remove a node from the grid.
+	 *
+	 * \param id: The node to remove
+	 */
+	void remove(NodeId id);
+
+	/**
+	 * Move a node to the cells under its new shape. Called by NodeStore::setPos().
+	 *
+	 * \param id: The node that moved
+	 * \param bounds: The new shape of the node
+	 */
+	void update(NodeId id, const SDL_Rect& bounds);
+
+	/**
+	 * Remove every node from the grid.
+	 */
+	void clear();
+
+	/**
+	 * Find the node at a point. If nodes overlap, the one drawn on top is returned.
+	 *
+	 * \param x: The x position of the point
+	 * \param y: The y position of the point
+	 * \return The node at x,y, or NO_NODE if there isn't one
+	 */
+	NodeId queryPoint(int x, int y);
+
+	/**
+	 * Find every node that overlaps a rectangle.
+	 *
+	 * \param area: The rectangle to search
+	 * \param out: The vector the nodes are written to, in the order they're drawn (bottom first). Its previous
+	 * contents are cleared
+	 */
+	void queryRect(const SDL_Rect& area, std::vector<NodeId>& out);
+
+	/**
+	 * Find every cluster cell with nodes in it that overlaps a rectangle. This only looks at the cells, so the time
+	 * taken doesn't depend on the number of nodes.
+	 *
+	 * \param area: The rectangle to search
+	 * \param out: The vector the clusters are written to. Its previous contents are cleared
+	 */
+	void queryClusters(const SDL_Rect& area, std::vector<Cluster>& out);
+
+	/**
+	 * \return The number of nodes in the grid.
+	 */
+	int size() { return count; }
+
+private:
+	//A node listed in a cell, along with its shape and its place in the drawing order
+	struct Entry {
+		NodeId id;
+		unsigned int order;
+		SDL_Rect bounds;
+	};
+
+	//What the grid remembers about each node, so it can be found again when the node moves or is removed
+	struct Record {
+		//The shape the node had when it was put in its cells
+		SDL_Rect bounds;
+
+		//The order the node was inserted in. Higher numbers are drawn later, on top
+		unsigned int order;
+
+		//True if the node is in the grid
+		bool present = false;
+	};
+
+	/**
+	 * Find the range of cells a rectangle overlaps.
+	 */
+	void getCellRange(const SDL_Rect& area, int* first_x, int* first_y, int* last_x, int* last_y);
+
+	/**
+	 * \return The key of the cell at cell_x, cell_y in 'cells'.
+	 */
+	static unsigned long long getCellKey(int cell_x, int cell_y) { return ((unsigned long long)(unsigned int)cell_x << 32) | (unsigned int)cell_y; }
+
+	/**
+	 * \return The cell holding a coordinate. Rounds towards negative infinity, so negative positions work too.
+	 */
+	static int getCell(int coordinate) { return (int)std::floor((double)coordinate / SPATIAL_GRID_CELL_SIZE); }
+
+	/**
+	 * \return The key, in 'clusters', of the cluster cell holding the center of bounds.
+	 */
+	static unsigned long long getClusterKey(const SDL_Rect& bounds);
+
+	/**
+	 * \return The cluster cell holding a coordinate, rounding towards negative infinity like getCell().
+	 */
+	static int getClusterCell(int coordinate) { return (int)std::floor((double)coordinate / CLUSTER_CELL_SIZE); }
+
+	/**
+	 * Change the number of nodes in a cluster cell by amount. Cells left empty are removed.
+	 */
+	void addToCluster(unsigned long long key, int amount);
+
+	/**
+	 * Add an entry to, or remove it from, every cell that bounds overlaps.
+	 */
+	void addToCells(const SDL_Rect& bounds, Entry entry);
+	void removeFromCells(const SDL_Rect& bounds, NodeId id);
+
+	//The nodes in each cell that holds any, keyed by getCellKey()
+	std::unordered_map<unsigned long long, std::vector<Entry>> cells;
+
+	//The number of nodes in each cluster cell that holds any, keyed by getClusterKey()
+	std::unordered_map<unsigned long long, int> clusters;
+
+	//The record for each node, indexed by NodeId
+	std::vector<Record> records;
+
+	//The number of nodes in the grid
+	int count = 0;
+
+	//The order given to the next node inserted
+	unsigned int next_order = 0;
+
+};
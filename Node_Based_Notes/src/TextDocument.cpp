@@ -0,0 +1,235 @@
+//Author: Connor Kamrowski. See header file for more information.
+#include "TextDocument.h"
+
+//Copy all of the text into a string.
+std::string TextDocument::toString() const {
+	std::string text;
+	copy(0, length(), text);
+	return text;
+}
+
+//Get the selection, in order from start to end.
+void TextDocument::getSelection(int* start, int* end) const {
+	*start = std::min(cursor, anchor);
+	*end = std::max(cursor, anchor);
+}
+
+//Copy the selected text into a string.
+std::string TextDocument::getSelectedText() const {
+	int start, end;
+	getSelection(&start, &end);
+
+	std::string text;
+	copy(start, end - start, text);
+	return text;
+}
+
+//Set the anchor and cursor directly, keeping both within the text.
+void TextDocument::setSelection(int new_anchor, int new_cursor) {
+	anchor = std::max(0, std::min(new_anchor, length()));
+	cursor = std::max(0, std::min(new_cursor, length()));
+}
+
+//Move the cursor to a position, extending or clearing the selection.
+void TextDocument::setCursor(int position, bool select) {
+	cursor = std::max(0, std::min(position, length()));
+
+	if (!select) {
+		anchor = cursor;
+	}
+}
+
+//Step the cursor over whole characters, left or right.
+void TextDocument::moveCursor(int characters, bool select) {
+	//Without shift, the left and right arrow keys just collapse a selection to its start or end
+	if (!select && hasSelection() && characters != 0) {
+		int start, end;
+		getSelection(&start, &end);
+		setCursor(characters < 0 ? start : end);
+		return;
+	}
+
+	int position = cursor;
+	for (int i = 0; i < characters; i++) {
+		position = nextCharacter(position);
+	}
+	for (int i = 0; i > characters; i--) {
+		position = previousCharacter(position);
+	}
+
+	setCursor(position, select);
+}
+
+//Insert text at the cursor, replacing any selection.
+TextEdit TextDocument::insert(const char* text, int count) {
+	TextEdit edit = eraseSelection();
+
+	insertAt(cursor, text, count);
+	edit.inserted = count;
+
+	cursor = anchor = cursor + count;
+
+	return edit;
+}
+
+//Delete the selection, or the character before the cursor.
+TextEdit TextDocument::backspace() {
+	if (hasSelection()) {
+		return eraseSelection();
+	}
+
+	TextEdit edit;
+	edit.position = previousCharacter(cursor);
+	edit.removed = cursor - edit.position;
+
+	eraseAt(edit.position, edit.removed);
+	cursor = anchor = edit.position;
+
+	return edit;
+}
+
+//Delete the selection, or the character after the cursor.
+TextEdit TextDocument::deleteForward() {
+	if (hasSelection()) {
+		return eraseSelection();
+	}
+
+	TextEdit edit;
+	edit.position = cursor;
+	edit.removed = nextCharacter(cursor) - cursor;
+
+	eraseAt(edit.position, edit.removed);
+
+	return edit;
+}
+
+/**
+ * Handle a key press or text input. Shift extends the selection while moving the cursor, and ctrl is used for the
+ * clipboard shortcuts.
+ */
+TextEdit TextDocument::handleKeyPress(SDL_Event* event, bool allow_line_breaks) {
+	TextEdit edit;
+
+	//If the event was a text input from the keyboard, add it at the cursor
+	if (event->type == SDL_TEXTINPUT) {
+		return insert(event->text.text, (int)strlen(event->text.text));
+	}
+
+	if (event->type != SDL_KEYDOWN) {
+		return edit;
+	}
+
+	bool shift = (event->key.keysym.mod & KMOD_SHIFT) != 0;
+	bool ctrl = (event->key.keysym.mod & KMOD_CTRL) != 0;
+
+	//Switch to a task based on the key that was pressed
+	switch (event->key.keysym.sym) {
+	case (SDLK_BACKSPACE):
+		edit = backspace();
+		break;
+	case (SDLK_DELETE):
+		edit = deleteForward();
+		break;
+	case (SDLK_RETURN):
+		if (allow_line_breaks) {
+			edit = insert("\n", 1);
+		}
+		break;
+	case (SDLK_LEFT):
+		moveCursor(-1, shift);
+		break;
+	case (SDLK_RIGHT):
+		moveCursor(1, shift);
+		break;
+	case (SDLK_HOME):
+		setCursor(0, shift);
+		break;
+	case (SDLK_END):
+		setCursor(length(), shift);
+		break;
+	case (SDLK_a):
+		if (ctrl) {
+			selectAll();
+		}
+		break;
+	case (SDLK_c):
+	case (SDLK_x):
+		if (ctrl && hasSelection()) {
+			SDL_SetClipboardText(getSelectedText().c_str());
+
+			//Cutting also removes the selection
+			if (event->key.keysym.sym == SDLK_x) {
+				edit = eraseSelection();
+			}
+		}
+		break;
+	case (SDLK_v):
+		if (ctrl) {
+			char* clipboard = SDL_GetClipboardText();
+
+			//Remove carriage returns, and line breaks if they aren't allowed
+			std::string pasted;
+			for (int i = 0; clipboard[i] != '\0'; i++) {
+				if (clipboard[i] != '\r' && (allow_line_breaks || clipboard[i] != '\n')) {
+					pasted += clipboard[i];
+				}
+			}
+			SDL_free(clipboard);
+
+			edit = insert(pasted.c_str(), (int)pasted.length());
+		}
+		break;
+	default:
+		break;
+	}
+
+	return edit;
+
+}//END OF handleKeyPress()
+
+//Delete the selected text, returning the edit made.
+TextEdit TextDocument::eraseSelection() {
+	TextEdit edit;
+	edit.position = cursor;
+
+	if (hasSelection()) {
+		int start, end;
+		getSelection(&start, &end);
+
+		eraseAt(start, end - start);
+
+		edit.position = start;
+		edit.removed = end - start;
+		cursor = anchor = start;
+	}
+
+	return edit;
+}
+
+//Find the start of the previous character, skipping any UTF-8 continuation bytes (10xxxxxx).
+int TextDocument::previousCharacter(int position) const {
+	if (position <= 0) {
+		return 0;
+	}
+
+	position--;
+	while (position > 0 && (at(position) & 0xC0) == 0x80) {
+		position--;
+	}
+
+	return position;
+}
+
+//Find the start of the next character, skipping any UTF-8 continuation bytes (10xxxxxx).
+int TextDocument::nextCharacter(int position) const {
+	if (position >= length()) {
+		return length();
+	}
+
+	position++;
+	while (position < length() && (at(position) & 0xC0) == 0x80) {
+		position++;
+	}
+
+	return position;
+}
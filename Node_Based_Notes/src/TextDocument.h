@@ -0,0 +1,251 @@
+/*
+ * TextDocument is the base class for the text models used by the text editor and text menus. It holds the cursor
+ * and selection, and everything that can be done with them (typing, deleting, moving the cursor, the clipboard), on
+ * top of a few functions that each model implements to store the text.
+ *
+ * There are two models:
+ *	* GapBuffer, a single array with a gap at the cursor. Used for most notes
+ *	* Rope, a balanced tree of text chunks. Used for very large notes (logs, transcripts) where one array is too slow
+ *
+ * Author: Connor Kamrowski
+ */
+#pragma once
+#include "Config.h"
+
+#include <memory>
+
+//Describes a single change to the text, so that anything depending on the text (like a TextLayout) can be updated
+struct TextEdit {
+	//The index where the edit happened
+	int position = 0;
+
+	//The number of characters removed at position
+	int removed = 0;
+
+	//The number of characters inserted at position, after the removal
+	int inserted = 0;
+
+	/**
+	 * \return true if the text was changed by this edit.
+	 */
+	bool changed() const { return removed > 0 || inserted > 0; }
+};
+
+//An unchangeable copy of a document's text. It can be read (or saved) from another thread while editing continues.
+class TextSnapshot {
+public:
+	virtual ~TextSnapshot() {}
+
+	/**
+	 * \return The number of characters in the snapshot.
+	 */
+	virtual int length() const = 0;
+
+	/**
+	 * Write all of the text to a file.
+	 *
+	 * \param file: The FILE* to write to
+	 * \return false if any of the text couldn't be written
+	 */
+	virtual bool write(FILE* file) const = 0;
+
+	/**
+	 * \return All of the text as a single string.
+	 */
+	virtual std::string toString() const = 0;
+};
+
+//A snapshot holding a plain copy of the text
+class StringSnapshot : public TextSnapshot {
+public:
+	/**
+	 * StringSnapshot constructor.
+	 *
+	 * \param text: The text to keep. It's moved into the snapshot
+	 */
+	StringSnapshot(std::string&& text) : text(std::move(text)) {}
+
+	int length() const { return (int)text.length(); }
+	bool write(FILE* file) const { return fwrite(text.data(), 1, text.length(), file) == text.length(); }
+	std::string toString() const { return text; }
+
+private:
+	//The copy of the text
+	std::string text;
+
+};
+
+class TextDocument {
+public:
+	virtual ~TextDocument() {}
+
+	/*** Storage, implemented by each text model ***/
+
+	/**
+	 * Replace all of the text, and place the cursor at the end of it with nothing selected.
+	 *
+	 * \param text: The new text
+	 * \param count: The number of characters in text
+	 */
+	virtual void assign(const char* text, int count) = 0;
+
+	/**
+	 * \return The number of characters in the text.
+	 */
+	virtual int length() const = 0;
+
+	/**
+	 * \param position: The index of a character, from 0 to length() - 1
+	 * \return The character at position.
+	 */
+	virtual char at(int position) const = 0;
+
+	/**
+	 * Copy part of the text into a string.
+	 *
+	 * \param start: The index of the first character to copy
+	 * \param count: The number of characters to copy
+	 * \param out: The string the text is copied into. Its previous contents are replaced
+	 */
+	virtual void copy(int start, int count, std::string& out) const = 0;
+
+	/**
+	 * Take a snapshot of the text, which stays the same no matter how the document is edited afterwards.
+	 *
+	 * \return The snapshot
+	 */
+	virtual std::shared_ptr<const TextSnapshot> snapshot() const = 0;
+
+	/**
+	 * \return All of the text as a single string.
+	 */
+	std::string toString() const;
+
+	/*** Cursor and Selection ***/
+
+	/**
+	 * \return The index of the cursor. The cursor sits before the character at this index.
+	 */
+	int getCursor() const { return cursor; }
+
+	/**
+	 * \return true if any text is selected.
+	 */
+	bool hasSelection() const { return cursor != anchor; }
+
+	/**
+	 * Get the range of the selected text. If nothing is selected, both are the cursor.
+	 *
+	 * \param start: Set to the index of the first selected character
+	 * \param end: Set to the index just after the last selected character
+	 */
+	void getSelection(int* start, int* end) const;
+
+	/**
+	 * \return The selected text.
+	 */
+	std::string getSelectedText() const;
+
+	/**
+	 * Move the cursor to a position.
+	 *
+	 * \param position: The new index of the cursor. It's kept within the text
+	 * \param select: If true, the selection is extended to the new position. Otherwise, the selection is cleared
+	 */
+	void setCursor(int position, bool select = false);
+
+	/**
+	 * Set both ends of the selection at once. Used to carry the selection over to a different document.
+	 *
+	 * \param new_anchor: The end of the selection that stays put
+	 * \param new_cursor: The end of the selection with the cursor
+	 */
+	void setSelection(int new_anchor, int new_cursor);
+
+	/**
+	 * \return The end of the selection that stays put while the cursor moves.
+	 */
+	int getAnchor() const { return anchor; }
+
+	/**
+	 * Move the cursor a number of characters left or right. Multi-byte (UTF-8) characters are stepped over whole.
+	 *
+	 * \param characters: The number of characters to move. Negative values move left
+	 * \param select: If true, the selection is extended to the new position. Otherwise, the selection is cleared
+	 */
+	void moveCursor(int characters, bool select = false);
+
+	/**
+	 * Select all of the text.
+	 */
+	void selectAll() { anchor = 0; cursor = length(); }
+
+	/*** Editing ***/
+
+	/**
+	 * Insert text at the cursor, replacing the selection if there is one. The cursor is moved after the new text.
+	 *
+	 * \param text: The text to insert
+	 * \param count: The number of characters in text
+	 * \return The change made to the text
+	 */
+	TextEdit insert(const char* text, int count);
+
+	/**
+	 * Delete the selection, or the character before the cursor if nothing is selected.
+	 *
+	 * \return The change made to the text
+	 */
+	TextEdit backspace();
+
+	/**
+	 * Delete the selection, or the character after the cursor if nothing is selected.
+	 *
+	 * \return The change made to the text
+	 */
+	TextEdit deleteForward();
+
+	/**
+	 * Edit the text based on a keyboard event: typing, backspace, delete, the arrow keys, home and end, and copy,
+	 * cut, paste or select all (with ctrl). This is shared by everything that accepts typed text.
+	 *
+	 * \param event: The SDL_Event* that describes the keys pressed
+	 * \param allow_line_breaks: If true, the return key inserts a line break
+	 * \return The change made to the text. Nothing changed if only the cursor moved
+	 */
+	TextEdit handleKeyPress(SDL_Event* event, bool allow_line_breaks);
+
+protected:
+	/**
+	 * Insert text at a position, without touching the cursor.
+	 */
+	virtual void insertAt(int position, const char* text, int count) = 0;
+
+	/**
+	 * Remove text at a position, without touching the cursor.
+	 */
+	virtual void eraseAt(int position, int count) = 0;
+
+	//The index of the cursor
+	int cursor = 0;
+
+	//The other end of the selection. If it equals the cursor, nothing is selected
+	int anchor = 0;
+
+private:
+	/**
+	 * Delete the selected text, leaving the cursor where it began.
+	 */
+	TextEdit eraseSelection();
+
+	/**
+	 * \return The index of the start of the character before position, skipping UTF-8 continuation bytes.
+	 */
+	int previousCharacter(int position) const;
+
+	/**
+	 * \return The index of the start of the character after position, skipping UTF-8 continuation bytes.
+	 */
+	int nextCharacter(int position) const;
+
+};
@@ -3,9 +3,9 @@
 
 /**
  * The TextEditor constructor. This initializes the position and shape of the text editor, and stores
- * the font passed from the graph manager.
+ * the font pool passed from the graph manager.
  */
-TextEditor::TextEditor(int window_width, int window_height, TTF_Font* input_font) {
+TextEditor::TextEditor(int window_width, int window_height, FontPool* input_fonts) : note_cache(&autosave_worker) {
 	//Initialize the shape
 	shape = new SDL_Rect();
 
@@ -14,147 +14,525 @@ TextEditor::TextEditor(int window_width, int window_height, TTF_Font* input_font
 	shape->w = window_width / TEXT_EDITOR_WIDTH_FACTOR;
 	shape->h = window_height;
 
-	//store the font to be used for editing text
-	font = input_font;
+	//store the fonts to be used for editing text
+	fonts = input_fonts;
+
+	//Notes start out in a gap buffer, until they grow past ROPE_THRESHOLD
+	document = new GapBuffer();
 
 }//END OF TextEditor()
 
 
 /**
- * The TextEditor deconstructor. This simply destroys the textures stored by the editor.
+ * The TextEditor deconstructor. This deletes the document.
  */
-TextEditor::~TextEditor() {}
+TextEditor::~TextEditor() {
+	delete document;
+}
 
 /**
- * Load a new Node into the text editor. This reads the file data at the file path stored by Node* target, and
- * stores it in local memory for easy access.
+ * Load a new Node into the text editor. If the note was prefetched, its text is taken from the note cache. Otherwise,
+ * this reads the file data at the target node's file path, and stores it in local memory for easy access. The whole
+ * file is read at once, and the time it took is reported.
  */
-void TextEditor::open(Node* target) {
-	std::ifstream node_file;
-	char c;
-
-	//Open the file that target represents
-	node_file.open(target->getFName());
-
-	//If node_file opened successfully
-	if (node_file.is_open()) {
-		
-		//While there are chars left in node_file
-		while (node_file.get(c)) {
-			//Append the line to file_data
-			file_data += c;
-		}
+void TextEditor::open(const std::string& path) {
+	std::string file_data;
 
-		//Add a placeholder "cursor" for the text editor
-		file_data += "|";
+	auto start_time = std::chrono::steady_clock::now();
 
-	} else {
-		std::cout << "Couldn't open file" << std::endl;
+	//If this note was just closed, its save may not be written yet, or may have failed. Take the text from the save
+	//instead of waiting for the disk, or reading the old text
+	std::shared_ptr<const TextSnapshot> unsaved = autosave_worker.getUnsaved(path);
+	std::shared_ptr<const std::string> cached = nullptr;
+	if (unsaved != nullptr) {
+		file_data = unsaved->toString();
+	}
+	//Otherwise use the prefetched text if there is some, or read the note from the graph's storage
+	else {
+		cached = note_cache.get(path);
+		if (cached == nullptr && (storage == nullptr || !storage->read(path, file_data))) {
+			std::cout << "Couldn't open file" << std::endl;
 
-		//This doesn't make good use of C++ error handling, but just toss it out the window if this happens...
-		exit(0);
+			//This doesn't make good use of C++ error handling, but just toss it out the window if this happens...
+			exit(0);
+		}
+	}
+	const std::string& text = (cached != nullptr) ? *cached : file_data;
+
+	//Load the text into the document, with the cursor at the end. Very large notes are loaded into a rope
+	useRope(text.length() >= ROPE_THRESHOLD);
+	document->assign(text.c_str(), (int)text.length());
+
+	//The note matches its file until it's edited. Text taken from a save counts as an edit already handed to the
+	//worker, so it's saved again if that save fails
+	open_path = path;
+	saved_generation = edit_generation;
+	if (unsaved != nullptr) {
+		edit_generation++;
 	}
+	queued_generation = edit_generation;
+	redraw_needed = true;
 
-	node_file.close();
+	//The new text needs a new layout, and starts at the top
+	layout_dirty = true;
+	scroll_y = 0;
+	preferred_x = -1;
+
+	//report how long the note took to load
+	auto load_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time);
+	std::cout << "Opened " << path << " (" << text.length() << " bytes" << ((cached != nullptr) ? ", prefetched" : "")
+		<< ((unsaved != nullptr) ? ", not saved yet" : "") << ") in " << load_time.count() / 1000.0 << " ms." << std::endl;
 
 }//END OF open()
 
 /**
- * Close the text editor. This takes the Node* target, finds the file it represents, and dumps the file_data back
- * into it to save any changes made while it was open.
+ * Close the text editor. This takes the path of the target node's file, and saves the document back
+ * into it if it was edited while it was open. Unedited notes aren't written at all.
  */
-void TextEditor::close(Node* target) {
-	//Get the file path from target
-	std::string outfile_path = target->getFName();
+void TextEditor::close(const std::string& path) {
+	//Only save if something was typed since the note was opened. The save happens in the background
+	if (isDirty()) {
+		autosave(path);
+	}
 
-	//Remove the cursor from the block of text
-	file_data.pop_back();
+	//Reset the document to an empty gap buffer
+	document->assign("", 0);
+	useRope(false);
+	redraw_needed = true;
 
-	//Open an output file stream using trunc, which writes over the previously stored information
-	std::ofstream outfile(outfile_path, std::ofstream::trunc);
+}//END OF close()
+
+/**
+ * Find how long until the note should be saved. It's saved once the user stops typing for AUTOSAVE_IDLE_MS, or right
+ * away after AUTOSAVE_EDIT_COUNT edits, so a long burst of typing is still saved regularly.
+ */
+int TextEditor::getAutosaveDelay() {
+	if (!isDirty()) {
+		//A save still being written is checked on again, so it's tried again if it fails
+		return (saved_generation != queued_generation) ? AUTOSAVE_IDLE_MS : -1;
+	}
 
-	//If it opened successfully, dump the data
-	if (outfile.good()) {
-		outfile << file_data;
+	if (edit_generation - queued_generation >= AUTOSAVE_EDIT_COUNT) {
+		return 0;
+	}
+
+	auto idle_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - last_edit_time);
+	return std::max(0, AUTOSAVE_IDLE_MS - (int)idle_time.count());
+}
+
+/**
+ * Hand a snapshot of the document to the worker thread. It isn't considered saved until the worker has written it. Any
+ * cached copy of the note is now old.
+ */
+void TextEditor::autosave(const std::string& path) {
+	autosave_worker.save(path, document->snapshot());
+
+	//Invalidated after the save is queued, so a read starting now waits for the save instead of reading old text
+	note_cache.invalidate(path);
+	queued_generation = edit_generation;
+	open_path = path;
+}
+
+//Check on the last save before deciding if there's anything to save.
+bool TextEditor::isDirty() {
+	checkSaved();
+	return edit_generation != queued_generation;
+}
+
+//Nothing changes until the worker is done with the save, either by writing it or by failing.
+void TextEditor::checkSaved() {
+	if (saved_generation == queued_generation || autosave_worker.isSaving(open_path)) {
+		return;
+	}
+
+	if (autosave_worker.hasFailed(open_path)) {
+		queued_generation = saved_generation;
 	}
 	else {
-		std::cout << "ERROR: The Node contents could not be saved upon exiting." << std::endl;
+		saved_generation = queued_generation;
+	}
+}
+
+//Save any edits, and wait until they're on the disk.
+void TextEditor::finishSaving(const std::string& path) {
+	if (isDirty()) {
+		autosave(path);
 	}
 
-	outfile.close();
+	autosave_worker.wait(path);
 
-	//Reset file data to empty
-	file_data = "";
+	//If the save failed, the document stays dirty and is saved again later, so the failed snapshot isn't needed
+	checkSaved();
+	autosave_worker.cancel(path);
 
-}//END OF close()
+	//The file is about to be moved, so a cached copy would be under the wrong path
+	note_cache.invalidate(path);
+}
+
+//Throw away any save of the file that hasn't been written yet, and any cached copy of it.
+void TextEditor::cancelSaving(const std::string& path) {
+	autosave_worker.cancel(path);
+	note_cache.invalidate(path);
+}
+
+//The worker and cache switch first, as they wait for anything still using the old storage.
+void TextEditor::setStorage(NoteStorage* storage) {
+	autosave_worker.setStorage(storage);
+	note_cache.setStorage(storage);
+	this->storage = storage;
+}
 
 /**
  * Close the text editor without saving. Called when a node is deleted.
  */
 void TextEditor::close() {
-	//TODO: is this all?
-	file_data = "";
+	document->assign("", 0);
+	useRope(false);
+	redraw_needed = true;
 }
 
 /**
- * Render the text editor. This includes the header, and all of file_data.
+ * Render the text editor. This includes the header, the scroll bar, and the lines of the document that can be seen,
+ * along with the selection and cursor. Only the visible lines (plus a few lines of overscan) are drawn, so the cost
+ * of a frame depends on the height of the window rather than the size of the file.
  */
-void TextEditor::render(SDL_Renderer* renderer, Node* target) {
+void TextEditor::render(SDL_Renderer* renderer, const std::string& title) {
 
 	//Draw the text editor background
 	DrawRectWithBorder(renderer, shape, BORDER_WIDTH, &WHITE, &BLACK);
 
+	GlyphAtlas* atlas = TextureManager::getAtlas(renderer, fonts, CONTENT_FONT_SIZE);
+	content_atlas = atlas;
+
+	//If the file was just opened, lay out the whole document. Otherwise, the layout was kept up to date by each edit
+	if (layout_dirty) {
+		//Lines are wrapped before they reach the scroll bar
+		int content_width = shape->w - LEFT_TEXT_BUFFER - SCROLL_BAR_WIDTH - BORDER_WIDTH;
+
+		layout.reset(*document, atlas, content_width);
+		line_height = atlas->getLineHeight();
+		layout_dirty = false;
+	}
+
+	//The line holding the cursor
+	int cursor_line = layout.getLineAt(document->getCursor());
+
+	//After an edit or cursor movement, scroll just far enough that the cursor can be seen
+	if (scroll_to_cursor) {
+		scroll_y = std::min(scroll_y, cursor_line * line_height);
+		scroll_y = std::max(scroll_y, (cursor_line + 1) * line_height - getViewHeight());
+		scroll_to_cursor = false;
+	}
+
+	//Keep the scroll position within the text, it may have shrunk since the last frame
+	scroll(0);
+
+	//The range of lines that can be seen, plus the overscan above and below
+	int first_line = std::max(0, scroll_y / line_height - EDITOR_OVERSCAN_LINES);
+	int last_line = std::min(layout.getLineCount() - 1, (scroll_y + getViewHeight()) / line_height + EDITOR_OVERSCAN_LINES);
+
+	//Only draw inside of the area below the header, so partially visible lines don't overlap it
+	SDL_Rect view = { 0, HEADER_HEIGHT, shape->w, getViewHeight() };
+	SDL_RenderSetClipRect(renderer, &view);
+
+	int selection_start, selection_end;
+	document->getSelection(&selection_start, &selection_end);
+
+	//Render the visible part of the document, one line at a time from the layout
+	for (int i = first_line; i <= last_line; i++) {
+		TextLine line = layout.getLine(i);
+		int line_y = HEADER_HEIGHT + i * line_height - scroll_y;
+
+		//Highlight the part of this line that is selected, behind the text
+		int highlight_start = std::max(selection_start, line.start);
+		int highlight_end = std::min(selection_end, line.start + line.length);
+		if (highlight_start < highlight_end) {
+			int highlight_x = measureToPosition(atlas, line, highlight_start);
+			int highlight_w = measureToPosition(atlas, line, highlight_end) - highlight_x;
+			Custom_SDLDrawRect(renderer, &SELECTION_COLOR, LEFT_TEXT_BUFFER + highlight_x, line_y, highlight_w, line_height);
+		}
+
+		document->copy(line.start, line.length, line_text);
+		atlas->queueText(line_text.c_str(), line.length, &BLACK, LEFT_TEXT_BUFFER, line_y);
+	}
+
+	atlas->flush(renderer);
+
+	//Draw the cursor as a thin bar in front of the character it sits before
+	int cursor_x = measureToPosition(atlas, layout.getLine(cursor_line), document->getCursor());
+	Custom_SDLDrawRect(renderer, &BLACK, LEFT_TEXT_BUFFER + cursor_x, HEADER_HEIGHT + cursor_line * line_height - scroll_y, CURSOR_WIDTH, line_height);
+
+	//Draw the scroll bar, if the text doesn't fit
+	SDL_Rect thumb;
+	if (getScrollThumb(&thumb)) {
+		Custom_SDLDrawRect(renderer, &SCROLL_BAR_TRACK_COLOR, thumb.x, HEADER_HEIGHT, thumb.w, getViewHeight());
+		Custom_SDLDrawRect(renderer, &SCROLL_BAR_THUMB_COLOR, &thumb);
+	}
+
+	SDL_RenderSetClipRect(renderer, NULL);
+
 	//Draw the text editor header
 	DrawRectWithBorder(renderer, 0, 0, shape->w, HEADER_HEIGHT, BORDER_WIDTH, &HEADER_BACKGROUND_COLOR, &BLACK);
 
 	//Render the header text
-	TextureManager::loadText(renderer, font, target->getTitle().c_str(), &BLACK, LEFT_TEXT_BUFFER, 0, HEADER_FONT_SIZE);
+	TextureManager::loadCachedText(renderer, fonts, title, &BLACK, LEFT_TEXT_BUFFER, 0, HEADER_FONT_SIZE);
 
-	//Render file_data
-	TextureManager::loadWrappedText(renderer, font, file_data.c_str(), &BLACK, LEFT_TEXT_BUFFER, HEADER_HEIGHT, shape->w, 20);
+	//Everything is up to date until the next change
+	redraw_needed = false;
 
 }//END OF render()
 
 /**
- * If the event was a keyboard button, handle that event for the text editor. This includes backspace, enter, and
- * typing more text into the file.
+ * If the event was a keyboard button, handle that event for the text editor. The keys that move between lines
+ * depend on the layout, and are handled here. Everything else (typing, backspace, enter, left and right, the
+ * clipboard) is handled by the document.
  */
 void TextEditor::handleKeyPress(SDL_Event* event) {
 
-	//If the event was a key pressed down
-	if (event->type == SDL_KEYDOWN) {
-		//If it was a backspace, and there is data left to delete
-		if (event->key.keysym.sym == SDLK_BACKSPACE && file_data.length() > 1) {
-			//Delete the cursor, displayed as '|'
-			file_data.pop_back();
-
-			//Delete the character 
-			file_data.pop_back();
-
-			//Put the cursor back onto the end
-			file_data += "|";
-		}//Else if it was the enter/return key
-		else if (event->key.keysym.sym == SDLK_RETURN) {
-			//Remove the cursor
-			file_data.pop_back();
-
-			//Add a line break and replace the cursor
-			file_data += "\n|";
+	//Show the cursor after typing or moving it, even if the user had scrolled away
+	scroll_to_cursor = true;
+	redraw_needed = true;
+
+	//Up, down, home and end need to know where the lines wrap
+	if (handleLineMovement(event)) {
+		return;
+	}
+
+	//Any other key stops the cursor from remembering its column
+	preferred_x = -1;
+
+	//Edit the document, and update the layout to match
+	TextEdit change = document->handleKeyPress(event, true);
+	if (change.changed()) {
+		updateLayout(change);
+		edit_generation++;
+		last_edit_time = std::chrono::steady_clock::now();
+
+		//If a note grows past the threshold (usually from pasting), move it into a rope
+		if (!large_document && document->length() >= ROPE_THRESHOLD) {
+			useRope(true);
 		}
 	}
 
-	//If the event was a text input from the keyboard
-	if (event->type == SDL_TEXTINPUT) {
+}//END OF handleKeyPress()
+
+/**
+ * Update the layout for an edit to the document. Only the paragraphs around the edit are wrapped again.
+ */
+void TextEditor::updateLayout(const TextEdit& change) {
+	//If the layout will be rebuilt anyway, there's nothing to update
+	if (layout_dirty) {
+		return;
+	}
+
+	layout.edit(*document, change);
+}
 
-		//Remove the cursor
-		file_data.pop_back();
+/**
+ * Move the text into a different kind of document. The text, cursor and selection are carried over, so the layout
+ * doesn't change.
+ */
+void TextEditor::useRope(bool rope) {
+	if (rope == large_document) {
+		return;
+	}
 
-		//Add the text from the event
-		file_data += event->text.text;
+	TextDocument* replacement;
+	if (rope) {
+		replacement = new Rope();
+	}
+	else {
+		replacement = new GapBuffer();
+	}
+
+	std::string text = document->toString();
+	replacement->assign(text.c_str(), (int)text.length());
+	replacement->setSelection(document->getAnchor(), document->getCursor());
+
+	delete document;
+	document = replacement;
+	large_document = rope;
+
+}//END OF useRope()
 
-		//Replace the cursor
-		file_data += "|";
+/**
+ * Move the cursor between lines. While moving up and down, the cursor remembers the x position it started at, so
+ * passing through a short line doesn't pull it to the left.
+ */
+bool TextEditor::handleLineMovement(SDL_Event* event) {
+	//These keys need the layout, which is only ready after the first render
+	if (event->type != SDL_KEYDOWN || layout_dirty) {
+		return false;
 	}
 
-}//END OF handleKeyPress()
+	bool shift = (event->key.keysym.mod & KMOD_SHIFT) != 0;
+	int cursor_line = layout.getLineAt(document->getCursor());
+	TextLine line = layout.getLine(cursor_line);
+
+	//The number of lines to move
+	int lines = 0;
+
+	//Switch to a task based on the key that was pressed
+	switch (event->key.keysym.sym) {
+	case (SDLK_UP):
+		lines = -1;
+		break;
+	case (SDLK_DOWN):
+		lines = 1;
+		break;
+	case (SDLK_PAGEUP):
+		lines = -getViewHeight() / line_height;
+		break;
+	case (SDLK_PAGEDOWN):
+		lines = getViewHeight() / line_height;
+		break;
+	case (SDLK_HOME):
+		//Move to the start of this line
+		document->setCursor(line.start, shift);
+		preferred_x = -1;
+		return true;
+	case (SDLK_END):
+		//Move to the end of this line
+		document->setCursor(layout.getPositionAt(*document, cursor_line, shape->w), shift);
+		preferred_x = -1;
+		return true;
+	default:
+		return false;
+	}
 
+	//Remember where the cursor started, the first time it moves vertically
+	if (preferred_x == -1) {
+		preferred_x = measureToPosition(content_atlas, line, document->getCursor());
+	}
+
+	//Move to the closest position in the new line, staying within the document
+	int new_line = std::max(0, std::min(cursor_line + lines, layout.getLineCount() - 1));
+	document->setCursor(layout.getPositionAt(*document, new_line, preferred_x), shift);
+
+	return true;
+
+}//END OF handleLineMovement()
+
+//Measure from the start of the line to the position.
+int TextEditor::measureToPosition(GlyphAtlas* atlas, const TextLine& line, int position) {
+	document->copy(line.start, position - line.start, line_text);
+	return atlas->measureText(line_text.c_str(), position - line.start);
+}
+
+/**
+ * Handle the mouse wheel, the scroll bar, and clicking in the text. Dragging the scroll bar or a selection continues
+ * even if the mouse leaves the editor, until the button is released.
+ */
+bool TextEditor::handleMouseEvent(SDL_Event* event, int mousex, int mousey) {
+	//Scroll with the mouse wheel while over the text editor
+	if (event->type == SDL_MOUSEWHEEL && isWithin(mousex, mousey, 0, HEADER_HEIGHT, shape->w, getViewHeight())) {
+		scroll(-event->wheel.y * EDITOR_SCROLL_SPEED);
+		return true;
+	}
+
+	SDL_Rect thumb;
+	bool has_scroll_bar = getScrollThumb(&thumb);
+
+	//Start dragging if the scroll bar was clicked
+	if (event->type == SDL_MOUSEBUTTONDOWN && event->button.button == SDL_BUTTON_LEFT && has_scroll_bar
+		&& isWithin(mousex, mousey, thumb.x, HEADER_HEIGHT, thumb.w, getViewHeight())) {
+		dragging_scroll_bar = true;
+
+		//If the track was clicked instead of the thumb, jump so the thumb is centered on the mouse
+		drag_offset = isWithin(mousex, mousey, thumb.x, thumb.y, thumb.w, thumb.h) ? mousey - thumb.y : thumb.h / 2;
+	}
+	else if (event->type == SDL_MOUSEBUTTONUP && dragging_scroll_bar) {
+		dragging_scroll_bar = false;
+		return true;
+	}
+	else if (event->type != SDL_MOUSEMOTION || !dragging_scroll_bar) {
+		//Nothing to do with scrolling, check if the text was clicked instead
+		return selectText(event, mousex, mousey);
+	}
+
+	//Move the thumb to the mouse, and scroll the same fraction of the text
+	int track_space = getViewHeight() - thumb.h;
+	if (track_space > 0) {
+		int thumb_y = mousey - drag_offset - HEADER_HEIGHT;
+		scroll(thumb_y * (getContentHeight() - getViewHeight()) / track_space - scroll_y);
+	}
+
+	return true;
+
+}//END OF handleMouseEvent()
+
+/**
+ * Clicking in the text moves the cursor to the mouse, and dragging selects the text between the click and the mouse.
+ * Holding shift while clicking extends the current selection instead.
+ */
+bool TextEditor::selectText(SDL_Event* event, int mousex, int mousey) {
+	//The text can't be clicked until it has been laid out
+	if (layout_dirty) {
+		return false;
+	}
+
+	bool extend_selection;
+
+	//Start selecting when the text is clicked
+	if (event->type == SDL_MOUSEBUTTONDOWN && event->button.button == SDL_BUTTON_LEFT
+		&& isWithin(mousex, mousey, 0, HEADER_HEIGHT, shape->w, getViewHeight())) {
+		selecting_text = true;
+		extend_selection = (SDL_GetModState() & KMOD_SHIFT) != 0;
+	}
+	else if (event->type == SDL_MOUSEMOTION && selecting_text) {
+		extend_selection = true;
+	}
+	else if (event->type == SDL_MOUSEBUTTONUP && selecting_text) {
+		selecting_text = false;
+		return true;
+	}
+	else {
+		return false;
+	}
+
+	//Find the line under the mouse, staying within the document if the mouse is above or below it
+	int line = (mousey - HEADER_HEIGHT + scroll_y) / line_height;
+	line = std::max(0, std::min(line, layout.getLineCount() - 1));
+
+	document->setCursor(layout.getPositionAt(*document, line, mousex - LEFT_TEXT_BUFFER), extend_selection);
+	preferred_x = -1;
+	scroll_to_cursor = true;
+	redraw_needed = true;
+
+	return true;
+
+}//END OF selectText()
+
+//Scroll by a number of pixels, without going past the top or bottom of the text.
+void TextEditor::scroll(int pixels) {
+	scroll_y += pixels;
+
+	//Don't scroll past the last line
+	scroll_y = std::min(scroll_y, getContentHeight() - getViewHeight());
+
+	//Or above the first
+	scroll_y = std::max(scroll_y, 0);
+
+	redraw_needed = true;
+}
+
+/**
+ * The thumb's height is the fraction of the text that can be seen, and it's placed the same fraction of the way
+ * down the track as the view is scrolled down the text.
+ */
+bool TextEditor::getScrollThumb(SDL_Rect* thumb) {
+	int content_height = getContentHeight();
+	int view_height = getViewHeight();
+
+	//Everything fits, there's nothing to scroll
+	if (content_height <= view_height) {
+		return false;
+	}
+
+	thumb->w = SCROLL_BAR_WIDTH;
+	thumb->x = shape->w - BORDER_WIDTH - SCROLL_BAR_WIDTH;
+	thumb->h = std::max(SCROLL_BAR_MIN_THUMB_HEIGHT, (int)((long long)view_height * view_height / content_height));
+	thumb->y = HEADER_HEIGHT + (int)((long long)scroll_y * (view_height - thumb->h) / (content_height - view_height));
+
+	return true;
+}
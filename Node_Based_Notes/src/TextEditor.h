@@ -9,7 +9,12 @@
 #include "Utils.h"
 
 #include "TextureManager.h"
-#include "Node.h"
+#include "TextLayout.h"
+#include "GapBuffer.h"
+#include "Rope.h"
+#include "NoteStorage.h"
+#include "AutosaveWorker.h"
+#include "NoteCache.h"
 
 
 class TextEditor {
@@ -19,9 +24,9 @@ public:
 	 *
 	 * \param window_width: The width of the application window
 	 * \param window_height: The height of the application window
-	 * \param input_font: The font used to display text
+	 * \param input_fonts: The pool of fonts used to display text
 	 */
-	TextEditor(int window_width, int window_height, TTF_Font* input_font);
+	TextEditor(int window_width, int window_height, FontPool* input_fonts);
 
 	/**
 	 * TextEditor deconstructor. This frees a few textures stored by the TextEditor.
@@ -29,55 +34,258 @@ public:
 	~TextEditor();
 
 	/**
-	 * Open the text editor, loading the relevant data from a file and into private variable 'file_data'. 
+	 * Open the text editor, loading the relevant data from a file and into private variable 'document'. 
 	 * The file's path is stored in the target node.
 	 *
-	 * \param target: The node to load information for
+	 * \param path: The path to the target node's file
 	 */
-	void open(Node* target);
+	void open(const std::string& path);
 
 	/**
-	 * A respective function to open(). Save the text stored in private variable 'file_data' to the path stored in
-	 * the target node.
+	 * Read a note in the background, so it opens without waiting on the disk if it's opened soon.
 	 *
-	 * \param target: The node to load information for
+	 * \param path: The path to the note's file
 	 */
-	void close(Node* target);
+	void prefetch(const std::string& path) { note_cache.prefetch(path); }
+
+	/**
+	 * A respective function to open(). Save the text stored in private variable 'document' to the path stored in
+	 * the target node, if it was edited. The file is written in the background, and replaced atomically.
+	 *
+	 * \param path: The path to the target node's file
+	 */
+	void close(const std::string& path);
 
 	/**
 	 * An overload for closing the text editor without saving the file; intended to be called if the file is being deleted.
 	 */
 	void close();
 
+	/**
+	 * \return true if the document has been edited since it was opened or last handed to the autosave worker, or if
+	 * the last save of it couldn't be written.
+	 */
+	bool isDirty();
+
+	/**
+	 * \return true if anything shown by the text editor has changed since it was last rendered.
+	 */
+	bool needsRedraw() { return redraw_needed; }
+
+	/**
+	 * \return The number of milliseconds until the document should be autosaved, 0 if it's due now, or -1 if there
+	 * is nothing to save. While a save is being written, this is how long until it's checked on again.
+	 */
+	int getAutosaveDelay();
+
+	/**
+	 * Save the document to the target node's file in the background. This doesn't wait for the file to be written.
+	 *
+	 * \param path: The path to the file the document belongs to
+	 */
+	void autosave(const std::string& path);
+
+	/**
+	 * Save the document if it was edited, and wait until the file is completely written. Called before the file
+	 * is renamed.
+	 *
+	 * \param path: The path to the file the document belongs to
+	 */
+	void finishSaving(const std::string& path);
+
+	/**
+	 * Cancel any save of the file that hasn't started, and wait for one that has. Called before the file is
+	 * deleted.
+	 *
+	 * \param path: The path to the file the document belongs to
+	 */
+	void cancelSaving(const std::string& path);
+
+	/**
+	 * Change the storage notes are read from and saved into, when a graph is opened or closed, or its notes are
+	 * moved to a different storage. Waits for every save to the old storage to finish.
+	 *
+	 * \param storage: The graph's storage. Null when no graph is open
+	 */
+	void setStorage(NoteStorage* storage);
+
 	/**
 	 * Display the graphics relevant to the text editor. This includes the editor's background, the header, the header's
-	 * text, and the text stored in 'file_data'.
+	 * text, the text stored in 'document', the selection and the cursor.
 	 *
 	 * \param renderer: The SDL_Renderer* being used
-	 * \param target: The node to pull a title from
+	 * \param title: The title of the target node, shown in the header
 	 */
-	void render(SDL_Renderer* renderer, Node* target);
+	void render(SDL_Renderer* renderer, const std::string& title);
 
 	/**
-	 * If a keyboard button was pressed, or a text input was created, edit the text stored in 'file_data' appropriately.
+	 * If a keyboard button was pressed, or a text input was created, edit the text stored in 'document' appropriately.
+	 * This includes typing, moving the cursor with the arrow keys, and selecting text with shift.
 	 *
 	 * \param event: The SDL_Event* that describes the keys pressed
 	 */
 	void handleKeyPress(SDL_Event* event);
 
+	/**
+	 * Handle mouse events for the text editor's viewport: scrolling with the mouse wheel, dragging the scroll bar, and
+	 * placing the cursor or selecting text by clicking and dragging.
+	 *
+	 * \param event: The SDL_Event* describing a user input to the program
+	 * \param mousex: The x position of the mouse
+	 * \param mousey: The y position of the mouse
+	 * \return true if the event was used by the viewport
+	 */
+	bool handleMouseEvent(SDL_Event* event, int mousex, int mousey);
+
+	/**
+	 * Scroll the contents of the text editor. The scroll position is kept within the text.
+	 *
+	 * \param pixels: The distance to scroll. Positive values scroll down
+	 */
+	void scroll(int pixels);
+
 	/**
 	 * \return The SDL_Rect* that describes the x, y, width, and height of this text editor
 	 */
 	SDL_Rect* getShape() { return shape; }
 
 private:
-	//The text in the target node's file, to be edited by this text editor
-	std::string file_data;
+	/**
+	 * Update the layout after the document was edited. If the layout hasn't been built yet, it's built on the next
+	 * render.
+	 *
+	 * \param change: The edit made to the document
+	 */
+	void updateLayout(const TextEdit& change);
+
+	/**
+	 * Move the cursor using the layout, for the keys that depend on where lines wrap: up, down, page up, page down,
+	 * home and end.
+	 *
+	 * \param event: The SDL_Event* that describes the key pressed
+	 * \return true if the key was one of these, and the cursor was moved
+	 */
+	bool handleLineMovement(SDL_Event* event);
+
+	/**
+	 * Move the cursor to the mouse when the text is clicked, and extend the selection while the mouse is dragged.
+	 *
+	 * \param event: The SDL_Event* describing a user input to the program
+	 * \param mousex: The x position of the mouse
+	 * \param mousey: The y position of the mouse
+	 * \return true if the event was used to place the cursor or select text
+	 */
+	bool selectText(SDL_Event* event, int mousex, int mousey);
+
+	/**
+	 * Measure the distance from the start of a line to a position within it.
+	 *
+	 * \param atlas: The GlyphAtlas* used to measure the text
+	 * \param line: The line holding position
+	 * \param position: An index into the document, between the start and end of line
+	 * \return The distance in pixels
+	 */
+	int measureToPosition(GlyphAtlas* atlas, const TextLine& line, int position);
+
+	/**
+	 * Check whether the worker has finished the last save handed to it. If it was written, the document is saved up
+	 * to that edit. If it failed, the edits since the last save that was written are saved again.
+	 */
+	void checkSaved();
+
+	/**
+	 * Switch the document between a GapBuffer and a Rope, keeping its text and cursor.
+	 *
+	 * \param rope: If true, the document becomes a Rope. Otherwise, it becomes a GapBuffer
+	 */
+	void useRope(bool rope);
+
+	//The text in the target node's file, to be edited by this text editor. The cursor and selection are kept in here
+	TextDocument* document;
+
+	//Counts every edit made to the document. Never reset, so it's different after any edit
+	unsigned int edit_generation = 0;
+
+	//The edit_generation when the document was last handed to the autosave worker. If they match, there's nothing to save
+	unsigned int queued_generation = 0;
+
+	//The edit_generation of the last save that was written, or when the note was opened from its file
+	unsigned int saved_generation = 0;
+
+	//The path of the open note, which the autosave worker is checked for
+	std::string open_path;
+
+	//The time of the most recent edit, for waiting until the user stops typing to autosave
+	std::chrono::steady_clock::time_point last_edit_time;
+
+	//The storage of the open graph's notes
+	NoteStorage* storage = nullptr;
+
+	//Writes saved notes to disk on a background thread
+	AutosaveWorker autosave_worker;
+
+	//Reads notes on a background thread before they're opened. Made after autosave_worker, which it waits on
+	NoteCache note_cache;
+
+	//Indicates that the document is a Rope, because the note is larger than ROPE_THRESHOLD
+	bool large_document = false;
+
+	//Where the document is broken into lines. Kept between frames, and only updated where the document is edited
+	TextLayout layout;
+
+	//The text of the line being drawn or measured. Kept between calls so the memory is reused
+	std::string line_text;
+
+	//The x position the cursor is trying to stay at while moving up and down lines. -1 if it isn't moving vertically
+	int preferred_x = -1;
+
+	//Indicates that text is being selected by dragging the mouse
+	bool selecting_text = false;
+
+	//The GlyphAtlas* for the text of the document. Set on the first render
+	GlyphAtlas* content_atlas = nullptr;
+
+	//Indicates that the layout must be built from scratch before it is drawn
+	bool layout_dirty = true;
+
+	//Indicates that the text, cursor, selection or scroll position changed, and the editor must be drawn again
+	bool redraw_needed = true;
+
+	/**
+	 * Find the position and size of the scroll bar's thumb, based on the scroll position.
+	 *
+	 * \param thumb: Set to the x, y, width and height of the thumb
+	 * \return false if all of the text fits in the editor, and there is no scroll bar
+	 */
+	bool getScrollThumb(SDL_Rect* thumb);
+
+	/**
+	 * \return The height of the area below the header where the document is drawn.
+	 */
+	int getViewHeight() { return shape->h - HEADER_HEIGHT - BORDER_WIDTH; }
+
+	/**
+	 * \return The height of the whole document, if every line were drawn.
+	 */
+	int getContentHeight() { return layout.getLineCount() * line_height; }
+
+	//The distance, in pixels, that the contents are scrolled down from the top of the text
+	int scroll_y = 0;
+
+	//The height of a line of text. Set when the text is laid out
+	int line_height = 0;
+
+	//Indicates that the view should scroll to show the cursor on the next render
+	bool scroll_to_cursor = false;
+
+	//Indicates that the scroll bar's thumb is being dragged, and the offset from the mouse to the top of the thumb
+	bool dragging_scroll_bar = false;
+	int drag_offset = 0;
 
 	//The x,y and shape of the text editor
 	SDL_Rect* shape;
 
-	//A pointer to the TTF_Font used by the text editor
-	TTF_Font* font;
+	//A pointer to the pool of fonts used by the text editor
+	FontPool* fonts;
 
 };
@@ -0,0 +1,210 @@
+//Author: Connor Kamrowski. See header file for more information.
+#include "TextLayout.h"
+
+/**
+ * Lay out the text from the beginning, wrapping every paragraph.
+ */
+void TextLayout::reset(const TextDocument& text, GlyphAtlas* new_atlas, int container_width) {
+	atlas = new_atlas;
+	width = container_width;
+	wrap_count = 0;
+
+	paragraphs.clear();
+	buildParagraphs(text, 0, text.length(), paragraphs);
+	buildIndex();
+
+}//END OF reset()
+
+/**
+ * Wrap only the paragraphs touched by an edit. The range from the start of the first touched paragraph to the end of
+ * the last one is split into paragraphs again (the edit may have added or removed line breaks), and those replace the
+ * old paragraphs. If there are as many as before, only their sizes change in the index. Otherwise the paragraphs after
+ * them have moved in the vector, and the index is built again.
+ */
+void TextLayout::edit(const TextDocument& text, const TextEdit& change) {
+	//The first and last paragraphs touched by the edit, in the text before the edit
+	int first = findParagraph(change.position);
+	int last = findParagraph(change.position + change.removed);
+
+	//The range of those paragraphs in the edited text
+	int start = getParagraphStart(first);
+	int end = getParagraphStart(last) + paragraphs.at(last).length + change.inserted - change.removed;
+
+	//wrap the touched range again
+	std::vector<Paragraph> rebuilt;
+	buildParagraphs(text, start, end, rebuilt);
+
+	if ((int)rebuilt.size() == last - first + 1) {
+		//replace the old paragraphs one for one. The paragraphs after the edit are untouched
+		for (int i = 0; i < (int)rebuilt.size(); i++) {
+			Paragraph& paragraph = paragraphs.at(first + i);
+			Paragraph& replacement = rebuilt.at(i);
+
+			addToIndex(first + i, replacement.length - paragraph.length,
+				(int)replacement.lines.size() - (int)paragraph.lines.size());
+			std::swap(paragraph, replacement);
+		}
+	}
+	else {
+		//replace the old paragraphs with the new ones
+		paragraphs.erase(paragraphs.begin() + first, paragraphs.begin() + last + 1);
+		paragraphs.insert(paragraphs.begin() + first, rebuilt.begin(), rebuilt.end());
+
+		buildIndex();
+	}
+
+}//END OF edit()
+
+//Find a line by index, converting its start to a position in the whole text.
+TextLine TextLayout::getLine(int line_index) {
+	//find the paragraph holding the line
+	int index = findIn(paragraph_lines, line_index);
+	const Paragraph& paragraph = paragraphs.at(index);
+
+	TextLine line = paragraph.lines.at(line_index - sumBefore(paragraph_lines, index));
+	line.start += getParagraphStart(index);
+
+	return line;
+}
+
+//Find the line holding a position, by finding its paragraph and then the line within the paragraph.
+int TextLayout::getLineAt(int position) {
+	int index = findParagraph(position);
+	const Paragraph& paragraph = paragraphs.at(index);
+	int relative = position - getParagraphStart(index);
+
+	//find the last line starting at or before the position
+	int line = 0;
+	while (line + 1 < (int)paragraph.lines.size() && paragraph.lines.at(line + 1).start <= relative) {
+		line++;
+	}
+
+	return sumBefore(paragraph_lines, index) + line;
+}
+
+/**
+ * Walk along the line, adding up the width of each character, and stop at the character boundary nearest to x.
+ */
+int TextLayout::getPositionAt(const TextDocument& text, int line_index, int x) {
+	TextLine line = getLine(line_index);
+	text.copy(line.start, line.length, scratch);
+
+	int pen_x = 0;
+	for (int i = 0; i < line.length; i++) {
+		//Skip UTF-8 continuation bytes, the cursor can't be placed inside of a character
+		if ((scratch[i] & 0xC0) == 0x80) {
+			continue;
+		}
+
+		int advance = atlas->getAdvance(scratch[i]);
+
+		//If x is in the left half of this character, the cursor goes before it
+		if (x < pen_x + advance / 2) {
+			return line.start + i;
+		}
+
+		pen_x += advance;
+	}
+
+	//x is past the end of the text. Wrapped lines end with a space, so stay in front of it to remain on this line
+	if (line.length > 0 && scratch[line.length - 1] == ' ' && line.start + line.length < text.length()
+		&& text.at(line.start + line.length) != '\n') {
+		return line.start + line.length - 1;
+	}
+
+	return line.start + line.length;
+}
+
+/**
+ * Split the range into paragraphs at every line break, and wrap each of them. The range is copied out of the document
+ * once, so the text is scanned as one string no matter how the document stores it.
+ */
+void TextLayout::buildParagraphs(const TextDocument& text, int start, int end, std::vector<Paragraph>& out) {
+	text.copy(start, end - start, scratch);
+
+	int paragraph_start = 0;
+	int range_length = end - start;
+
+	for (int i = 0; i <= range_length; i++) {
+		//A paragraph ends at a line break, or at the end of the range
+		if (i == range_length || scratch[i] == '\n') {
+			Paragraph paragraph;
+			paragraph.length = i - paragraph_start;
+
+			atlas->wrapText(scratch.c_str() + paragraph_start, paragraph.length, width, paragraph.lines);
+			wrap_count++;
+
+			out.push_back(paragraph);
+			paragraph_start = i + 1;
+		}
+	}
+}
+
+/**
+ * Build both trees in O(n). Each node starts as its own paragraph's size, and once it's complete, it's added to the
+ * next node whose range covers it.
+ */
+void TextLayout::buildIndex() {
+	int size = (int)paragraphs.size();
+	paragraph_lengths.assign(size + 1, 0);
+	paragraph_lines.assign(size + 1, 0);
+	line_count = 0;
+
+	for (int i = 1; i <= size; i++) {
+		const Paragraph& paragraph = paragraphs.at(i - 1);
+
+		//count the paragraph's line break with it, so the sum before a paragraph is its start
+		paragraph_lengths.at(i) += paragraph.length + 1;
+		paragraph_lines.at(i) += (int)paragraph.lines.size();
+		line_count += (int)paragraph.lines.size();
+
+		int parent = i + (i & -i);
+		if (parent <= size) {
+			paragraph_lengths.at(parent) += paragraph_lengths.at(i);
+			paragraph_lines.at(parent) += paragraph_lines.at(i);
+		}
+	}
+}
+
+//Add the change to every node whose range covers the paragraph.
+void TextLayout::addToIndex(int paragraph, int length_change, int line_change) {
+	line_count += line_change;
+
+	for (int i = paragraph + 1; i < (int)paragraph_lengths.size(); i += i & -i) {
+		paragraph_lengths.at(i) += length_change;
+		paragraph_lines.at(i) += line_change;
+	}
+}
+
+//Add up the nodes covering the first 'count' paragraphs, dropping the lowest bit of the index each step.
+int TextLayout::sumBefore(const std::vector<int>& tree, int count) {
+	int sum = 0;
+	for (int i = count; i > 0; i -= i & -i) {
+		sum += tree.at(i);
+	}
+
+	return sum;
+}
+
+/**
+ * Walk down the tree from its largest power of two, taking each node whose sum still fits under value. The paragraphs
+ * taken all end at or before value, so the count taken is the index of the paragraph holding it.
+ */
+int TextLayout::findIn(const std::vector<int>& tree, int value) {
+	int size = (int)tree.size() - 1;
+
+	int step = 1;
+	while (step * 2 <= size) {
+		step *= 2;
+	}
+
+	int count = 0;
+	for (; step > 0; step /= 2) {
+		if (count + step <= size && tree.at(count + step) <= value) {
+			count += step;
+			value -= tree.at(count);
+		}
+	}
+
+	return count;
+}
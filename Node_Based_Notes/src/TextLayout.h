@@ -0,0 +1,148 @@
+/*
+ * TextLayout stores where the text editor's text is broken into lines. The text is split into paragraphs (separated
+ * by '\n'), and each paragraph keeps its own wrapped lines. When the text is edited, only the paragraphs touched by
+ * the edit are wrapped again, so typing into a large note doesn't re-wrap the whole document.
+ *
+ * Paragraphs don't store their own position or first line, as every paragraph after an edit would need to be changed.
+ * Instead, the length and line count of each paragraph are kept in two Fenwick trees (binary indexed trees), which
+ * give the position and first line of any paragraph, and the paragraph holding a position or line, in O(log n). An edit
+ * that doesn't add or remove a line break only updates the paragraphs it touched.
+ *
+ * Author: Connor Kamrowski
+ */
+#pragma once
+#include "Config.h"
+#include "GlyphAtlas.h"
+#include "TextDocument.h"
+
+//A run of text between two line breaks, and the lines it wraps into
+struct Paragraph {
+	//The number of characters in this paragraph, NOT including the '\n' that ends it
+	int length = 0;
+
+	//The wrapped lines of this paragraph. Line starts are relative to the start of the paragraph
+	std::vector<TextLine> lines;
+};
+
+class TextLayout {
+public:
+	/**
+	 * Lay out the whole text from scratch. This is used when a file is opened, or the width changes.
+	 *
+	 * \param text: The text to be laid out
+	 * \param atlas: The GlyphAtlas* used to measure the text
+	 * \param container_width: The maximum width of a line
+	 */
+	void reset(const TextDocument& text, GlyphAtlas* atlas, int container_width);
+
+	/**
+	 * Update the layout after the text was edited. Only the paragraphs the edit touched are wrapped again.
+	 *
+	 * \param text: The text AFTER the edit
+	 * \param change: The edit made to the text
+	 */
+	void edit(const TextDocument& text, const TextEdit& change);
+
+	/**
+	 * \return The number of lines in the whole text.
+	 */
+	int getLineCount() { return line_count; }
+
+	/**
+	 * Find a line by its index.
+	 *
+	 * \param line_index: The index of the line, from 0 to getLineCount() - 1
+	 * \return The line, with its start relative to the beginning of the text
+	 */
+	TextLine getLine(int line_index);
+
+	/**
+	 * Find the line that holds a position in the text. A position at the end of a wrapped line belongs to the line
+	 * after it, where typing would continue.
+	 *
+	 * \param position: An index into the text
+	 * \return The index of the line holding position
+	 */
+	int getLineAt(int position);
+
+	/**
+	 * Find the position in a line closest to an x coordinate. Used to place the cursor with the mouse, or when moving
+	 * between lines with the up and down arrow keys.
+	 *
+	 * \param text: The text that was laid out
+	 * \param line_index: The index of the line
+	 * \param x: The distance from the left of the line, in pixels
+	 * \return The index into the text closest to x
+	 */
+	int getPositionAt(const TextDocument& text, int line_index, int x);
+
+	/**
+	 * \return The number of paragraphs wrapped since the last call to reset(). Useful to check that edits stay local.
+	 */
+	int getWrapCount() { return wrap_count; }
+
+private:
+	/**
+	 * Split text[start, end) into paragraphs at each '\n', wrap each one, and write them to 'out'.
+	 */
+	void buildParagraphs(const TextDocument& text, int start, int end, std::vector<Paragraph>& out);
+
+	/**
+	 * Build both Fenwick trees from every paragraph. Used when paragraphs are added or removed.
+	 */
+	void buildIndex();
+
+	/**
+	 * Change the size of one paragraph in both Fenwick trees.
+	 *
+	 * \param paragraph: The index of the paragraph
+	 * \param length_change: The number of characters added to the paragraph. Negative if they were removed
+	 * \param line_change: The number of lines added to the paragraph. Negative if they were removed
+	 */
+	void addToIndex(int paragraph, int length_change, int line_change);
+
+	/**
+	 * \return The sum of the first 'count' paragraphs in a Fenwick tree.
+	 */
+	int sumBefore(const std::vector<int>& tree, int count);
+
+	/**
+	 * \return The number of paragraphs, from the start, whose sum in a Fenwick tree is at most value. This is the
+	 * index of the paragraph holding value.
+	 */
+	int findIn(const std::vector<int>& tree, int value);
+
+	/**
+	 * \return The index of the first character of a paragraph.
+	 */
+	int getParagraphStart(int paragraph) { return sumBefore(paragraph_lengths, paragraph); }
+
+	/**
+	 * \return The index of the paragraph holding the character at position.
+	 */
+	int findParagraph(int position) { return findIn(paragraph_lengths, position); }
+
+	//Every paragraph of the text, in order. There is always at least one
+	std::vector<Paragraph> paragraphs;
+
+	//Fenwick trees over the paragraphs, indexed from 1. One sums the length of each paragraph plus its line break, the
+	//other sums the number of lines in each paragraph
+	std::vector<int> paragraph_lengths;
+	std::vector<int> paragraph_lines;
+
+	//The atlas used to measure the width of text
+	GlyphAtlas* atlas = nullptr;
+
+	//The maximum width of a line
+	int width = 0;
+
+	//The total number of lines
+	int line_count = 0;
+
+	//The number of paragraphs wrapped since reset()
+	int wrap_count = 0;
+
+	//The text of the range being wrapped, or the line being measured. Kept between calls so the memory is reused
+	std::string scratch;
+
+};
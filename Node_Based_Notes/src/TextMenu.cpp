@@ -34,8 +34,6 @@ TextMenu::TextMenu(int screen_w, int screen_h, int menu_w, const char* menu_mess
 	//Set the menu message
 	message = menu_message;
 
-	text_input = "|";
-
 }
 
 std::string* TextMenu::waitEvent(SDL_Renderer* renderer) {
@@ -50,30 +48,21 @@ std::string* TextMenu::waitEvent(SDL_Renderer* renderer) {
 		SDL_WaitEvent(&event);
 
 		//Handle the key press
-
-		//TODO: This code is used multiple times. Clean it up, and make it a function that both can access. AND FIX THE CURSOR!!!
 		if (event.type == SDL_QUIT) {
 			return nullptr;
 		}
-		else if (event.type == SDL_KEYDOWN && text_input.length() > 1) {
-			if (event.key.keysym.sym == SDLK_BACKSPACE) {
-				//Delete a character
-				text_input.pop_back();
-				text_input.pop_back();
-				text_input += "|";
-			}
-			else if (event.key.keysym.sym == SDLK_RETURN) {
-				//Finish with the text menu and return
+		else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_RETURN) {
+			//Finish with the text menu and return, as long as something was typed
+			if (text_input.length() > 0) {
 				SDL_RenderClear(renderer);
 
-				text_input.pop_back();
-				return &text_input;
+				response = text_input.toString();
+				return &response;
 			}
 		}
-		else if (event.type == SDL_TEXTINPUT) {
-			text_input.pop_back();
-			text_input += event.text.text;
-			text_input += "|";
+		else if (event.type == SDL_KEYDOWN || event.type == SDL_TEXTINPUT) {
+			//Typing, deleting and moving the cursor are handled the same way as the text editor
+			text_input.handleKeyPress(&event, false);
 		}
 		else {
 			continue;
@@ -95,13 +84,29 @@ void TextMenu::render(SDL_Renderer* renderer) {
 	Custom_SDLDrawRect(renderer, &WHITE, message_shape);
 
 	//render the message
-	TextureManager::loadWrappedText(renderer, GraphManager::font, message.c_str(), &BLACK, menu_shape->x + MENU_CONTENT_PADDING, menu_shape->y + MENU_CONTENT_PADDING, content_width, MENU_MESSAGE_FONT_SIZE);
+	TextureManager::loadCachedWrappedText(renderer, GraphManager::fonts, message, &BLACK, menu_shape->x + MENU_CONTENT_PADDING, menu_shape->y + MENU_CONTENT_PADDING, content_width, MENU_MESSAGE_FONT_SIZE);
 
 	//render the text box
 	Custom_SDLDrawRect(renderer, &WHITE, text_box_shape);
 
+	std::string text = text_input.toString();
+	GlyphAtlas* atlas = TextureManager::getAtlas(renderer, GraphManager::fonts, MENU_TEXT_INPUT_FONT_SIZE);
+
+	//highlight the selected text
+	int selection_start, selection_end;
+	text_input.getSelection(&selection_start, &selection_end);
+	if (selection_start < selection_end) {
+		int highlight_x = atlas->measureText(text.c_str(), selection_start);
+		int highlight_w = atlas->measureText(text.c_str() + selection_start, selection_end - selection_start);
+		Custom_SDLDrawRect(renderer, &SELECTION_COLOR, text_box_shape->x + highlight_x, text_box_shape->y, highlight_w, text_box_shape->h);
+	}
+
 	//render the text in the text box
-	TextureManager::loadText(renderer, GraphManager::font, text_input.c_str(), &BLACK, text_box_shape->x, text_box_shape->y, MENU_TEXT_INPUT_FONT_SIZE);
+	TextureManager::loadText(renderer, GraphManager::fonts, text.c_str(), &BLACK, text_box_shape->x, text_box_shape->y, MENU_TEXT_INPUT_FONT_SIZE);
+
+	//render the cursor after the text before it
+	int cursor_x = atlas->measureText(text.c_str(), text_input.getCursor());
+	Custom_SDLDrawRect(renderer, &BLACK, text_box_shape->x + cursor_x, text_box_shape->y, CURSOR_WIDTH, text_box_shape->h);
 
 	SDL_RenderPresent(renderer);
 
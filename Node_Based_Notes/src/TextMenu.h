@@ -1,6 +1,7 @@
 #pragma once
 #include "Config.h"
 #include "GraphManager.h"
+#include "GapBuffer.h"
 
 class TextMenu {
 public:
@@ -12,7 +13,11 @@ public:
 private:
 	SDL_Rect* text_box_shape;
 
-	std::string text_input;
+	//The text typed by the user, along with the cursor and selection
+	GapBuffer text_input;
+
+	//The finished text, returned by waitEvent()
+	std::string response;
 
 	//The SDL_Rect for the menu
 	SDL_Rect* menu_shape;
@@ -0,0 +1,124 @@
+//Author: Connor Kamrowski. See header file for more information.
+#include "TextureCache.h"
+
+/**
+ * The TextureCache constructor. The cache starts out empty.
+ */
+TextureCache::TextureCache(size_t byte_budget) {
+	budget = byte_budget;
+}
+
+/**
+ * The TextureCache deconstructor. Destroy the textures still in the cache.
+ */
+TextureCache::~TextureCache() {
+	clear();
+}
+
+/**
+ * Find the texture for the text, or render it and add it to the cache. Found textures are moved to the front of the
+ * list, marking them as the most recently used.
+ */
+SDL_Texture* TextureCache::get(SDL_Renderer* renderer, FontPool* fonts, const std::string& text, const SDL_Color* color, int font_size, int wrap_width, int* w, int* h) {
+	TextureCacheKey key;
+	key.text_hash = std::hash<std::string>()(text);
+	key.font_size = font_size;
+	key.color = (Uint32)color->r << 24 | (Uint32)color->g << 16 | (Uint32)color->b << 8 | color->a;
+	key.wrap_width = wrap_width;
+
+	auto found = lookup.find(key);
+	if (found != lookup.end()) {
+		//Make sure it's the same text, and not just the same hash
+		if (found->second->text == text) {
+			hits++;
+
+			//move the entry to the front, it was just used
+			entries.splice(entries.begin(), entries, found->second);
+
+			*w = found->second->w;
+			*h = found->second->h;
+			return found->second->texture;
+		}
+
+		//Two strings share a hash. Replace the old one, it's rendered again if it's used again
+		erase(found->second);
+	}
+
+	misses++;
+
+	//borrow the font for this size, only for as long as it takes to render the surface
+	TTF_Font* font;
+	std::unique_lock<std::mutex> font_lock = fonts->acquire(font_size, &font);
+
+	//create a surface using the text input
+	SDL_Surface* temp_surface;
+	if (wrap_width > 0) {
+		temp_surface = TTF_RenderText_Blended_Wrapped(font, text.c_str(), *color, wrap_width);
+	}
+	else {
+		temp_surface = TTF_RenderText_Blended(font, text.c_str(), *color);
+	}
+
+	font_lock.unlock();
+
+	//Empty strings and errors don't create a surface
+	if (temp_surface == nullptr) {
+		return nullptr;
+	}
+
+	Entry entry;
+	entry.key = key;
+	entry.text = text;
+	entry.w = temp_surface->w;
+	entry.h = temp_surface->h;
+	entry.bytes = (size_t)entry.w * entry.h * 4;
+	entry.texture = SDL_CreateTextureFromSurface(renderer, temp_surface);
+
+	//free the temporary surface from memory, the texture is all that's needed
+	SDL_FreeSurface(temp_surface);
+
+	//add the entry as the most recently used
+	entries.push_front(entry);
+	lookup[key] = entries.begin();
+	bytes_used += entry.bytes;
+
+	//Make room for the new texture
+	evict();
+
+	*w = entry.w;
+	*h = entry.h;
+	return entry.texture;
+
+}//END OF get()
+
+//Destroy all textures in the cache.
+void TextureCache::clear() {
+	for (Entry& entry : entries) {
+		SDL_DestroyTexture(entry.texture);
+	}
+
+	entries.clear();
+	lookup.clear();
+	bytes_used = 0;
+}
+
+//Change the budget, and evict any textures that no longer fit.
+void TextureCache::setBudget(size_t new_budget) {
+	budget = new_budget;
+	evict();
+}
+
+//Evict the least recently used textures, found at the back of the list, until the cache fits in the budget.
+void TextureCache::evict() {
+	while (bytes_used > budget && entries.size() > 1) {
+		erase(std::prev(entries.end()));
+	}
+}
+
+//Remove a single entry from the cache, and destroy its texture.
+void TextureCache::erase(std::list<Entry>::iterator entry) {
+	bytes_used -= entry->bytes;
+	SDL_DestroyTexture(entry->texture);
+	lookup.erase(entry->key);
+	entries.erase(entry);
+}
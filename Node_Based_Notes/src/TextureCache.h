@@ -0,0 +1,147 @@
+/*
+ * TextureCache keeps the textures of text that is drawn over and over without changing, such as menu messages,
+ * button labels and node titles. Each texture is rendered once, then reused with a single SDL_RenderCopy.
+ *
+ * Textures are keyed by the text (hashed), font size, color and wrap width. When the textures use more memory than
+ * the byte budget, the least recently used textures are destroyed first.
+ *
+ * Author: Connor Kamrowski
+ */
+#pragma once
+#include "Config.h"
+#include "FontPool.h"
+
+#include <list>
+#include <unordered_map>
+
+//Everything that changes how a string of text looks, used to find its texture in the cache
+struct TextureCacheKey {
+	//The hash of the text
+	size_t text_hash;
+
+	//The font size of the text
+	int font_size;
+
+	//The color of the text, packed as RGBA
+	Uint32 color;
+
+	//The width the text was wrapped to. 0 if the text isn't wrapped
+	int wrap_width;
+
+	bool operator==(const TextureCacheKey& other) const {
+		return text_hash == other.text_hash && font_size == other.font_size && color == other.color && wrap_width == other.wrap_width;
+	}
+};
+
+//Combines the fields of a TextureCacheKey into a single hash for std::unordered_map
+struct TextureCacheKeyHash {
+	size_t operator()(const TextureCacheKey& key) const {
+		size_t hash = key.text_hash;
+		hash = hash * 31 + std::hash<int>()(key.font_size);
+		hash = hash * 31 + std::hash<Uint32>()(key.color);
+		hash = hash * 31 + std::hash<int>()(key.wrap_width);
+		return hash;
+	}
+};
+
+class TextureCache {
+public:
+	/**
+	 * TextureCache constructor.
+	 *
+	 * \param byte_budget: The maximum number of bytes of texture memory the cache may hold
+	 */
+	TextureCache(size_t byte_budget);
+
+	/**
+	 * TextureCache deconstructor. Destroys every cached texture.
+	 */
+	~TextureCache();
+
+	/**
+	 * Get the texture for a string of text, rendering it if it isn't in the cache. The texture belongs to the cache,
+	 * and must not be destroyed by the caller.
+	 *
+	 * \param renderer: The SDL_Renderer* being used
+	 * \param fonts: The FontPool* the font is borrowed from
+	 * \param text: The text to be loaded into a texture
+	 * \param color: The color of the text
+	 * \param font_size: The font size of the text
+	 * \param wrap_width: The maximum width of the text before wrapping to a new line. 0 if the text isn't wrapped
+	 * \param w: Set to the width of the texture
+	 * \param h: Set to the height of the texture
+	 * \return The texture holding the text, or nullptr if it couldn't be rendered
+	 */
+	SDL_Texture* get(SDL_Renderer* renderer, FontPool* fonts, const std::string& text, const SDL_Color* color, int font_size, int wrap_width, int* w, int* h);
+
+	/**
+	 * Destroy every cached texture.
+	 */
+	void clear();
+
+	/**
+	 * Change the byte budget, evicting textures if the cache is now over budget.
+	 *
+	 * \param new_budget: The maximum number of bytes of texture memory the cache may hold
+	 */
+	void setBudget(size_t new_budget);
+
+	/**
+	 * \return The number of times a texture was found in the cache.
+	 */
+	int getHits() { return hits; }
+
+	/**
+	 * \return The number of times a texture had to be rendered.
+	 */
+	int getMisses() { return misses; }
+
+	/**
+	 * \return The number of bytes of texture memory currently held by the cache.
+	 */
+	size_t getBytesUsed() { return bytes_used; }
+
+private:
+	//A cached texture, along with the text it was made from
+	struct Entry {
+		TextureCacheKey key;
+
+		//The full text, to tell apart two strings with the same hash
+		std::string text;
+
+		SDL_Texture* texture;
+		int w;
+		int h;
+
+		//The approximate memory used by the texture
+		size_t bytes;
+	};
+
+	/**
+	 * Destroy the least recently used textures until the cache is within its budget. The most recently used texture
+	 * is never evicted, even if it is larger than the whole budget.
+	 */
+	void evict();
+
+	/**
+	 * Destroy an entry's texture and remove it from the cache.
+	 */
+	void erase(std::list<Entry>::iterator entry);
+
+	//Every entry, with the most recently used at the front
+	std::list<Entry> entries;
+
+	//The location of each entry in 'entries', by key
+	std::unordered_map<TextureCacheKey, std::list<Entry>::iterator, TextureCacheKeyHash> lookup;
+
+	//The maximum number of bytes of texture memory
+	size_t budget;
+
+	//The number of bytes of texture memory currently held
+	size_t bytes_used = 0;
+
+	//The number of cache hits and misses
+	int hits = 0;
+	int misses = 0;
+
+};
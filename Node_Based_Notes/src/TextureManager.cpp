@@ -1,52 +1,80 @@
 #include "TextureManager.h"
 #include <iostream>
 
+//Initialize static private variables found in TextureManager
+std::unordered_map<int, GlyphAtlas*> TextureManager::atlases;
+std::vector<TextLine> TextureManager::wrapped_lines;
+TextureCache TextureManager::cache(TEXTURE_CACHE_BUDGET);
+
 //Display text in SDL using the given renderer.
-void TextureManager::loadText(SDL_Renderer* renderer, TTF_Font* font, const char* text, const SDL_Color* color, int x, int y, int font_size) {
-	SDL_Surface* temp_surface;
-	SDL_Texture* message_texture;
-	SDL_Rect temp;
+void TextureManager::loadText(SDL_Renderer* renderer, FontPool* fonts, const char* text, const SDL_Color* color, int x, int y, int font_size) {
+	//get the atlas holding the glyphs for this font size
+	GlyphAtlas* atlas = getAtlas(renderer, fonts, font_size);
 
-	//set the font to the desired size
-	TTF_SetFontSize(font, font_size);
+	//queue a quad for every character, then draw them all at once
+	atlas->queueText(text, (int)strlen(text), color, x, y);
+	atlas->flush(renderer);
+}
 
-	//create a surface using the text input
-	temp_surface = TTF_RenderText_Blended(font, text, *color);
+//Display text in SDL using the given renderer. The text will wrap around if it exceeds the container_width.
+void TextureManager::loadWrappedText(SDL_Renderer* renderer, FontPool* fonts, const char* text, const SDL_Color* color, int x, int y, int container_width, int font_size, bool centered) {
+	//get the atlas holding the glyphs for this font size
+	GlyphAtlas* atlas = getAtlas(renderer, fonts, font_size);
 
-	//set the dimensions of the temporary rect to match the surface, which scales in width based on the text input
-	temp.w = temp_surface->w;
-	temp.h = temp_surface->h;
-	temp.x = x;
-	temp.y = y;
+	int length = (int)strlen(text);
 
-	//create the texture, storing it in the texture pointer parameter
-	message_texture = SDL_CreateTextureFromSurface(renderer, temp_surface);
+	//break the text into lines that fit in the container
+	atlas->wrapText(text, length, container_width, wrapped_lines);
 
-	//display the texture to the renderer (so that it appears when the renderer is presented)
-	SDL_RenderCopy(renderer, message_texture, NULL, &temp);
+	//The text is placed as one block, so it's as wide as its widest line
+	int block_width = 0;
+	for (int i = 0; i < (int)wrapped_lines.size(); i++) {
+		block_width = std::max(block_width, wrapped_lines.at(i).width);
+	}
 
-	//free the temporary surface from memory
-	SDL_FreeSurface(temp_surface);
+	int block_x = x;
+	if (centered) {
+		//Place the text in the center
+		block_x = x + container_width / 2 - block_width / 2;
+	}
+
+	//queue every line below the last, then draw them all at once
+	for (int i = 0; i < (int)wrapped_lines.size(); i++) {
+		const TextLine& line = wrapped_lines.at(i);
+		atlas->queueText(text + line.start, line.length, color, block_x, y + i * atlas->getLineHeight());
+	}
+
+	atlas->flush(renderer);
 
-	//free the temporary texture from memory
-	SDL_DestroyTexture(message_texture);
 }
 
-//Display text in SDL using the given renderer. The text will wrap around if it exceeds the container_width.
-void TextureManager::loadWrappedText(SDL_Renderer* renderer, TTF_Font* font, const char* text, const SDL_Color* color, int x, int y, int container_width, int font_size, bool centered) {
-	SDL_Surface* temp_surface;
-	SDL_Texture* message_texture;
+//Display text using a cached texture, rendering it only if it isn't already in the cache.
+void TextureManager::loadCachedText(SDL_Renderer* renderer, FontPool* fonts, const std::string& text, const SDL_Color* color, int x, int y, int font_size) {
 	SDL_Rect temp;
 
-	//set the font to the desired size
-	TTF_SetFontSize(font, font_size);
+	//get the texture from the cache, there's nothing to draw if it couldn't be made
+	SDL_Texture* message_texture = cache.get(renderer, fonts, text, color, font_size, 0, &temp.w, &temp.h);
+	if (message_texture == nullptr) {
+		return;
+	}
+
+	temp.x = x;
+	temp.y = y;
 
-	//create a surface using the text input
-	temp_surface = TTF_RenderText_Blended_Wrapped(font, text, *color, container_width);
+	//display the texture to the renderer. The texture belongs to the cache, so it isn't destroyed
+	SDL_RenderCopy(renderer, message_texture, NULL, &temp);
+}
+
+//Display wrapped text using a cached texture, rendering it only if it isn't already in the cache.
+void TextureManager::loadCachedWrappedText(SDL_Renderer* renderer, FontPool* fonts, const std::string& text, const SDL_Color* color, int x, int y, int container_width, int font_size, bool centered) {
+	SDL_Rect temp;
+
+	//get the texture from the cache, there's nothing to draw if it couldn't be made
+	SDL_Texture* message_texture = cache.get(renderer, fonts, text, color, font_size, container_width, &temp.w, &temp.h);
+	if (message_texture == nullptr) {
+		return;
+	}
 
-	//set the dimensions of the temporary rect to match the surface, which scales in width and height based on the text input
-	temp.w = temp_surface->w;
-	temp.h = temp_surface->h;
 	if (centered) {
 		//Place the text in the center
 		temp.x = x + container_width / 2 - temp.w / 2;
@@ -56,16 +84,35 @@ void TextureManager::loadWrappedText(SDL_Renderer* renderer, TTF_Font* font, con
 	}
 	temp.y = y;
 
-	//create the texture, storing it in the texture pointer parameter
-	message_texture = SDL_CreateTextureFromSurface(renderer, temp_surface);
-
-	//display the texture to the renderer (so that it appears when the renderer is presented)
+	//display the texture to the renderer. The texture belongs to the cache, so it isn't destroyed
 	SDL_RenderCopy(renderer, message_texture, NULL, &temp);
+}
+
+//Get the atlas for the given font size, creating it on first use.
+GlyphAtlas* TextureManager::getAtlas(SDL_Renderer* renderer, FontPool* fonts, int font_size) {
+	auto found = atlases.find(font_size);
+
+	//If the atlas exists, return it
+	if (found != atlases.end()) {
+		return found->second;
+	}
 
-	//free the temporary surface from memory
-	SDL_FreeSurface(temp_surface);
+	//Otherwise, rasterize the font at this size into a new atlas
+	TTF_Font* font;
+	std::unique_lock<std::mutex> font_lock = fonts->acquire(font_size, &font);
+	GlyphAtlas* atlas = new GlyphAtlas(renderer, font);
+	atlases[font_size] = atlas;
 
-	//free the temporary texture from memory
-	SDL_DestroyTexture(message_texture);
+	return atlas;
+}
+
+//Destroy all atlases, and every texture in the cache.
+void TextureManager::clean() {
+	cache.clear();
+
+	for (auto& entry : atlases) {
+		delete entry.second;
+	}
 
+	atlases.clear();
 }
@@ -2,10 +2,21 @@
  * TextureManager is a collection of static functions for loading something into an SDL_Texture.
  * This should most likely be merged with Utils.h, I just haven't gotten around to that.
  *
+ * Text is drawn from a GlyphAtlas, one for each font size. Each atlas is created the first time its size is drawn,
+ * so the font is only rasterized once per size instead of once per string, every frame.
+ *
+ * Text that rarely changes (menu messages, buttons, node titles) can instead be drawn with the "Cached" functions,
+ * which keep the whole string in a TextureCache so it costs a single SDL_RenderCopy.
+ *
  * Author: Connor Kamrowski
  */
 #pragma once
 #include "Config.h"
+#include "GlyphAtlas.h"
+#include "TextureCache.h"
+#include "FontPool.h"
+
+#include <unordered_map>
 
 class TextureManager {
 public:
@@ -13,20 +24,20 @@ public:
 	 * Display text using the given SDL_Renderer.
 	 *
 	 * \param renderer: The SDL_Renderer* being used
-	 * \param font: The TTF_Font* being used
+	 * \param fonts: The FontPool* the font is borrowed from
 	 * \param text: The text to be loaded into a texture
 	 * \param color: The color of the text
 	 * \param x: The x coordinate for the top-left corner of the text
 	 * \param y: The y coordinate for the top-left corner of the text
 	 * \param font_size: The font size of the text
 	 */
-	static void loadText(SDL_Renderer* renderer, TTF_Font* font, const char* message, const SDL_Color* color, int x, int y, int font_size);
+	static void loadText(SDL_Renderer* renderer, FontPool* fonts, const char* message, const SDL_Color* color, int x, int y, int font_size);
 
 	/**
 	 * Display text using the given SDL_Renderer. This text will wrap to the next line if it exceeds container_width.
 	 *
 	 * \param renderer: The SDL_Renderer* being used
-	 * \param font: The TTF_Font* being used
+	 * \param fonts: The FontPool* the font is borrowed from
 	 * \param text: The text to be loaded into a texture
 	 * \param color: The color of the text
 	 * \param x: The x coordinate for the top-left corner of the text
@@ -35,6 +46,65 @@ public:
 	 * \param font_size: The font size of the text
 	 * \param centered: Determines if the text will be centered or not
 	 */
-	static void loadWrappedText(SDL_Renderer* renderer, TTF_Font* font, const char* message, const SDL_Color* color, int x, int y, int container_width, int font_size, bool centered = false);
-};
+	static void loadWrappedText(SDL_Renderer* renderer, FontPool* fonts, const char* message, const SDL_Color* color, int x, int y, int container_width, int font_size, bool centered = false);
+
+	/**
+	 * Display text using the given SDL_Renderer, using a texture from the texture cache. Use this for text that is
+	 * drawn many times without changing.
+	 *
+	 * \param renderer: The SDL_Renderer* being used
+	 * \param fonts: The FontPool* the font is borrowed from
+	 * \param text: The text to be displayed
+	 * \param color: The color of the text
+	 * \param x: The x coordinate for the top-left corner of the text
+	 * \param y: The y coordinate for the top-left corner of the text
+	 * \param font_size: The font size of the text
+	 */
+	static void loadCachedText(SDL_Renderer* renderer, FontPool* fonts, const std::string& text, const SDL_Color* color, int x, int y, int font_size);
+
+	/**
+	 * Display wrapped text using the given SDL_Renderer, using a texture from the texture cache. Use this for text
+	 * that is drawn many times without changing.
+	 *
+	 * \param renderer: The SDL_Renderer* being used
+	 * \param fonts: The FontPool* the font is borrowed from
+	 * \param text: The text to be displayed
+	 * \param color: The color of the text
+	 * \param x: The x coordinate for the top-left corner of the text
+	 * \param y: The y coordinate for the top-left corner of the text
+	 * \param container_width: The maximum width of the text before wrapping to a new line
+	 * \param font_size: The font size of the text
+	 * \param centered: Determines if the text will be centered or not
+	 */
+	static void loadCachedWrappedText(SDL_Renderer* renderer, FontPool* fonts, const std::string& text, const SDL_Color* color, int x, int y, int container_width, int font_size, bool centered = false);
 
+	/**
+	 * \return The cache used by loadCachedText and loadCachedWrappedText, for its hit and miss counters.
+	 */
+	static TextureCache* getCache() { return &cache; }
+
+	/**
+	 * Get the glyph atlas for a font size, creating it if this is the first time the size is used.
+	 *
+	 * \param renderer: The SDL_Renderer* being used
+	 * \param fonts: The FontPool* the font is borrowed from
+	 * \param font_size: The font size of the atlas
+	 * \return The GlyphAtlas* for font_size
+	 */
+	static GlyphAtlas* getAtlas(SDL_Renderer* renderer, FontPool* fonts, int font_size);
+
+	/**
+	 * Destroy every glyph atlas and cached texture. This must be called before the renderer that created them is destroyed.
+	 */
+	static void clean();
+
+private:
+	//The glyph atlas for each font size that has been drawn, with the font size as the key
+	static std::unordered_map<int, GlyphAtlas*> atlases;
+
+	//The textures of text drawn with the "Cached" functions
+	static TextureCache cache;
+
+	//The lines of the last wrapped text. Kept between calls so the memory is reused
+	static std::vector<TextLine> wrapped_lines;
+};